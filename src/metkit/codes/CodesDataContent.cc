@@ -86,13 +86,15 @@ double CodesDataContent::getDouble(const std::string& key) const {
 //----------------------------------------------------------------------------------------------------------------------
 
 void CodesDataContent::getDoubleArray(const std::string& key, std::vector<double>& values) const {
-    values = handle_->getDoubleArray(key);
+    values.resize(handle_->size(key));
+    values.resize(handle_->getDoubleArray(key, values.data(), values.size()));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 void CodesDataContent::getFloatArray(const std::string& key, std::vector<float>& values) const {
-    values = handle_->getFloatArray(key);
+    values.resize(handle_->size(key));
+    values.resize(handle_->getFloatArray(key, values.data(), values.size()));
 }
 
 
@@ -106,17 +108,15 @@ size_t CodesDataContent::getSize(const std::string& key) const {
 //----------------------------------------------------------------------------------------------------------------------
 
 void CodesDataContent::getDoubleArray(const std::string& key, double* data, size_t len) const {
-    auto arr = handle_->getDoubleArray(key);
-    ASSERT(len == arr.size());
-    std::copy(arr.begin(), arr.end(), data);
+    size_t count = handle_->getDoubleArray(key, data, len);
+    ASSERT(count == len);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 void CodesDataContent::getFloatArray(const std::string& key, float* data, size_t len) const {
-    auto arr = handle_->getFloatArray(key);
-    ASSERT(len == arr.size());
-    std::copy(arr.begin(), arr.end(), data);
+    size_t count = handle_->getFloatArray(key, data, len);
+    ASSERT(count == len);
 }
 
 
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <sstream>
 
 
 namespace metkit {
@@ -39,71 +40,146 @@ bool GRIBDecoder::match(const eckit::message::Message& msg) const {
 }
 
 namespace {
+
 bool isInteger(double val) {
     double intpart;
     return std::modf(val, &intpart) == 0.0;
 }
-}  // namespace
 
+// TODO - remove as soon as https://jira.ecmwf.int/browse/ECC-2113 is fixed
+void gatherLevelist(eckit::message::MetadataGatherer& gather, double val,
+                    eckit::message::ValueRepresentation representation) {
+    if (representation == eckit::message::ValueRepresentation::String) {
+        if (isInteger(val)) {
+            gather.setValue("levelist", eckit::translate<std::string>(static_cast<long>(val)));
+        }
+        else {
+            gather.setValue("levelist", eckit::translate<std::string>(val));
+        }
+    }
+    else {
+        if (isInteger(val)) {
+            gather.setValue("levelist", static_cast<long>(val));
+        }
+        else {
+            gather.setValue("levelist", val);
+        }
+    }
+}
 
-void GRIBDecoder::getMetadata(const eckit::message::Message& msg, eckit::message::MetadataGatherer& gather,
-                              const eckit::message::GetMetadataOptions& options) const {
-    static std::string gribToRequestNamespace = eckit::Resource<std::string>("gribToRequestNamespace", "mars");
-    std::string nameSpace                     = options.nameSpace ? *options.nameSpace : gribToRequestNamespace;
+/// Keys from the section headers deciding which keys the mars namespace holds: edition, templates, type of level, and
+/// the class, stream and type selecting the mars definitions. paramId is read along, but is not part of the signature.
+const KeySet& headerKeys() {
+    static const KeySet keys{
+        {"edition", NativeType::Long, OnMissing::Skip},
+        {"localDefinitionNumber", NativeType::Long, OnMissing::Skip},
+        {"productDefinitionTemplateNumber", NativeType::Long, OnMissing::Skip},
+        {"gridDefinitionTemplateNumber", NativeType::Long, OnMissing::Skip},
+        {"dataRepresentationTemplateNumber", NativeType::Long, OnMissing::Skip},
+        {"dataRepresentationType", NativeType::Long, OnMissing::Skip},
+        {"typeOfFirstFixedSurface", NativeType::Long, OnMissing::Skip},
+        {"typeOfSecondFixedSurface", NativeType::Long, OnMissing::Skip},
+        {"indicatorOfTypeOfLevel", NativeType::Long, OnMissing::Skip},
+        {"marsClass", NativeType::String, OnMissing::Skip},
+        {"marsStream", NativeType::String, OnMissing::Skip},
+        {"marsType", NativeType::String, OnMissing::Skip},
+        {"paramId", NativeType::String, OnMissing::Skip},
+    };
+    return keys;
+}
 
-    auto h = codesHandleFromMessage({static_cast<const uint8_t*>(msg.data()), msg.length()});
+constexpr size_t localDefinitionNumberAt = 1;
+constexpr size_t paramIdAt               = 12;
+
+std::string signature(const KeyRecord& header, const std::string& nameSpace,
+                      eckit::message::ValueRepresentation representation) {
+    std::ostringstream oss;
+    oss << nameSpace << '/' << static_cast<int>(representation);
+    for (size_t i = 0; i < paramIdAt; ++i) {
+        oss << '/';
+        if (header.has(i)) {
+            std::visit(
+                [&](const auto& v) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(v)>, long> ||
+                                  std::is_same_v<std::decay_t<decltype(v)>, std::string>) {
+                        oss << v;
+                    }
+                },
+                header.get(i));
+        }
+    }
+    return oss.str();
+}
 
-    for (const auto& k : h->keys(nameSpace)) {
+/// The keys of a namespace gathered from a message
+struct Gathered {
+    std::vector<KeySpec> keys;       // qualified with the namespace, with the types they were gathered as
+    std::vector<std::string> names;  // as gathered
+    size_t count = 0;                // keys in the namespace, including those skipped
+};
+
+std::string qualified(const std::string& nameSpace, const std::string& name) {
+    return nameSpace.empty() ? name : nameSpace + "." + name;
+}
+
+/// Gathers the keys of a namespace by iterating it
+Gathered gatherAll(const CodesHandle& h, const std::string& nameSpace, eckit::message::MetadataGatherer& gather,
+                   eckit::message::ValueRepresentation representation) {
+    Gathered gathered;
+
+    // A key is read through the accessor of the namespace, a short name may be an alias of another key outside it
+    auto add = [&](const std::string& name, NativeType type) {
+        gathered.keys.push_back({qualified(nameSpace, name), type});
+        gathered.names.push_back(name);
+    };
+
+    for (const auto& k : h.keys(nameSpace)) {
         auto name = k.name();
+        ++gathered.count;
 
         if (name[0] == '_')
             continue;  // skip silly underscores in GRIB
 
         // Get key size to see if it is an array
         // Only continue for scalar values
-        const auto keySize = h->size(name);
+        const auto keySize = h.size(name);
         if (keySize != 1) {
             LOG_DEBUG_LIB(LibMetkit) << "GRIBDecoder::getMetadata skipping non-scalar key '" << name
                                      << "' (size=" << keySize << ")" << std::endl;
             continue;
         }
 
-        switch (options.valueRepresentation) {
+        if (name == "levelist") {
+            gatherLevelist(gather, k.getDouble(), representation);
+            add(name, NativeType::Double);
+            continue;
+        }
+
+        switch (representation) {
             case eckit::message::ValueRepresentation::String: {
-                // TODO - remove as soon as https://jira.ecmwf.int/browse/ECC-2113 is fixed
-                if (k.name() == "levelist") {
-                    double val = k.getDouble();
-                    if (isInteger(val)) {
-                        gather.setValue(name, eckit::translate<std::string>(static_cast<long>(val)));
-                    }
-                    else {
-                        gather.setValue(name, eckit::translate<std::string>(val));
-                    }
-                }
-                else {
-                    gather.setValue(name, k.getString());
-                }
+                gather.setValue(name, k.getString());
+                add(name, NativeType::String);
                 break;
             }
             case eckit::message::ValueRepresentation::Native: {
                 std::visit(
                     [&](auto&& v) {
                         using Type = std::decay_t<decltype(v)>;
-                        // TODO - remove as soon as https://jira.ecmwf.int/browse/ECC-2113 is fixed
-                        if (k.name() == "levelist") {
-                            double val = k.getDouble();
-                            if (isInteger(val)) {
-                                gather.setValue(name, static_cast<long>(val));
-                            }
-                            else {
-                                gather.setValue(name, val);
-                            }
+                        if constexpr (std::is_same_v<Type, std::string>) {
+                            gather.setValue(name, std::forward<decltype(v)>(v));
+                            add(name, NativeType::String);
+                        }
+                        else if constexpr (std::is_integral_v<Type>) {
+                            gather.setValue(name, std::forward<decltype(v)>(v));
+                            add(name, NativeType::Long);
                         }
-                        else if constexpr (std::is_same_v<Type, std::string> || std::is_arithmetic_v<Type>) {
+                        else if constexpr (std::is_floating_point_v<Type>) {
                             gather.setValue(name, std::forward<decltype(v)>(v));
+                            add(name, NativeType::Double);
                         }
                         else if constexpr (std::is_same_v<Type, std::vector<uint8_t>>) {
                             gather.setValue(name, k.getString());
+                            add(name, NativeType::String);
                         }
                         else {
                             // Unhandled types are all array types - the prior call checking `size != 1` only allows
@@ -119,13 +195,129 @@ void GRIBDecoder::getMetadata(const eckit::message::Message& msg, eckit::message
         }
     }
 
+    return gathered;
+}
+
+/// Gathers the keys found in an earlier message of the same signature. Returns false, having gathered nothing, if the
+/// namespace does not hold as many keys. Throws if one of the keys is missing, as all values are read before any is
+/// gathered nothing is then gathered either.
+bool gatherCached(const CodesHandle& h, const std::string& nameSpace, const KeySet& keys,
+                  const std::vector<std::string>& names, size_t count, eckit::message::MetadataGatherer& gather,
+                  eckit::message::ValueRepresentation representation) {
+    // Only the names are iterated, no key is inspected
+    size_t n   = 0;
+    auto range = h.keys(nameSpace);
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        ++n;
+    }
+    if (n != count) {
+        return false;
+    }
+
+    KeyRecord record(keys);
+    h.getKeys(keys, record);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const auto& name = names[i];
+        if (name == "levelist") {
+            gatherLevelist(gather, record.getDouble(i), representation);
+            continue;
+        }
+        switch (keys[i].type) {
+            case NativeType::Long:
+                gather.setValue(name, record.getLong(i));
+                break;
+            case NativeType::Double:
+                gather.setValue(name, record.getDouble(i));
+                break;
+            default:
+                gather.setValue(name, record.getString(i));
+                break;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+
+void GRIBDecoder::getMetadata(const eckit::message::Message& msg, eckit::message::MetadataGatherer& gather,
+                              const eckit::message::GetMetadataOptions& options) const {
+    static std::string gribToRequestNamespace = eckit::Resource<std::string>("gribToRequestNamespace", "mars");
+    static bool cacheKeys = eckit::Resource<bool>("gribDecoderCacheKeys;$METKIT_GRIB_DECODER_CACHE_KEYS", true);
+    std::string nameSpace = options.nameSpace ? *options.nameSpace : gribToRequestNamespace;
+
+    auto h = codesHandleFromMessage({static_cast<const uint8_t*>(msg.data()), msg.length()});
+
+    KeyRecord header(headerKeys());
+    h->getKeys(headerKeys(), header);
+
+    if (!cacheKeys) {
+        gatherAll(*h, nameSpace, gather, options.valueRepresentation);
+    }
+    else {
+        // Messages of the same signature hold the same keys, which are then read without inspecting them one by one.
+        // The cached keys are checked to be all the keys of the namespace, or they are gathered again
+        std::string sig = signature(header, nameSpace, options.valueRepresentation);
+
+        std::shared_ptr<const CachedKeys> cached;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex_);
+            auto it = cache_.find(sig);
+            if (it != cache_.end()) {
+                cached = it->second;
+            }
+        }
+
+        bool gathered = false;
+        if (cached) {
+            try {
+                gathered = gatherCached(*h, nameSpace, cached->keys, cached->names, cached->count, gather,
+                                        options.valueRepresentation);
+            }
+            catch (const CodesException& e) {
+                LOG_DEBUG_LIB(LibMetkit) << "GRIBDecoder::getMetadata keys cached for " << sig
+                                         << " not found: " << e.what() << std::endl;
+            }
+            if (!gathered) {
+                LOG_DEBUG_LIB(LibMetkit) << "GRIBDecoder::getMetadata keys cached for " << sig
+                                         << " do not match, iterating namespace" << std::endl;
+            }
+        }
+
+        if (!gathered) {
+            auto all = gatherAll(*h, nameSpace, gather, options.valueRepresentation);
+            try {
+                cached = std::make_shared<const CachedKeys>(
+                    CachedKeys{KeySet(std::move(all.keys)), std::move(all.names), all.count});
+            }
+            catch (const eckit::UserError& e) {
+                // Not a list of distinct scalar keys, so this signature is never cached
+                LOG_DEBUG_LIB(LibMetkit) << "GRIBDecoder::getMetadata not caching keys for " << sig << ": " << e.what()
+                                         << std::endl;
+                cached.reset();
+            }
+
+            std::lock_guard<std::mutex> lock(cacheMutex_);
+            if (cache_.size() >= maxCachedSignatures) {
+                cache_.clear();
+            }
+            if (cached) {
+                cache_[sig] = cached;
+            }
+            else {
+                cache_.erase(sig);
+            }
+        }
+    }
+
     // Explicit override for param (kludge for paramID handling)
-    if (h->has("paramId")) {
-        gather.setValue("param", h->getString("paramId"));
+    if (header.has(paramIdAt)) {
+        gather.setValue("param", header.getString(paramIdAt));
     }
 
     // Look for request embbeded in GRIB message
-    if (h->has("localDefinitionNumber") && h->getLong("localDefinitionNumber") == 191) {
+    if (header.has(localDefinitionNumberAt) && header.getLong(localDefinitionNumberAt) == 191) {
         /* TODO: Not grib2 compatible, but speed-up process */
         if (h->has("freeFormData")) {
             auto buffer = h->getBytes("freeFormData");
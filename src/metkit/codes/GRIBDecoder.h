@@ -13,11 +13,19 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "eckit/message/Decoder.h"
 #include "eckit/message/Message.h"
 
 #include "eckit/io/Buffer.h"
 
+#include "metkit/codes/api/KeySet.h"
+
 namespace metkit::codes {
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -34,6 +42,25 @@ private:  // methods
                      const eckit::message::GetMetadataOptions&) const override;
 
     eckit::Buffer decode(const eckit::message::Message& msg) const override;
+
+private:  // types
+
+    /// The keys of a namespace gathered from the first message of a signature
+    struct CachedKeys {
+        KeySet keys;                     // qualified with the namespace, with the types they were gathered as
+        std::vector<std::string> names;  // as gathered
+        size_t count;                    // keys in the namespace, including those skipped
+    };
+
+private:  // members
+
+    static constexpr size_t maxCachedSignatures = 1024;
+
+    /// Keys gathered from the first message of each signature (edition, templates, level types, mars class, stream and
+    /// type), read directly from later messages of that signature. A message is read as the first one if its namespace
+    /// holds a different number of keys, or misses one of them. Disabled by $METKIT_GRIB_DECODER_CACHE_KEYS=0.
+    mutable std::mutex cacheMutex_;
+    mutable std::map<std::string, std::shared_ptr<const CachedKeys>> cache_;
 };
 
 
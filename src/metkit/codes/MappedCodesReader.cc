@@ -0,0 +1,204 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MappedCodesReader.cc
+/// @date   Oct 2026
+
+#include "metkit/codes/MappedCodesReader.h"
+
+#include <sys/mman.h>
+
+#include <cstring>
+#include <sstream>
+
+#include "metkit/codes/CodesDataContent.h"
+#include "metkit/codes/api/CodesAPI.h"
+#include "metkit/utils/MappedFile.h"
+
+namespace metkit::codes {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+uint64_t bigEndian(const uint8_t* p, size_t n) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; ++i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+bool isMagic(const uint8_t* p) {
+    return std::memcmp(p, "GRIB", 4) == 0 || std::memcmp(p, "BUFR", 4) == 0 || std::memcmp(p, "BUDG", 4) == 0 ||
+           std::memcmp(p, "TIDE", 4) == 0;
+}
+
+/// Length of a GRIB 1 message. Messages longer than 8MB have bit 0x800000 of their length set and, if their section 4
+/// is shorter than 120 bytes, their length is counted in units of 120 bytes, less the length of section 4 (as in
+/// ecCodes). Otherwise the 24 bits are the length itself.
+uint64_t grib1Length(const uint8_t* p, size_t size) {
+    uint64_t length = bigEndian(p + 4, 3);
+    if (!(length & 0x800000)) {
+        return length;
+    }
+
+    // Skip sections 1, 2 and 3 to find the length of section 4
+    uint8_t flags = p[15];
+    uint64_t off  = 8 + bigEndian(p + 8, 3);
+    for (uint8_t present : {uint8_t(0x80), uint8_t(0x40)}) {
+        if (flags & present) {
+            if (off + 3 > size) {
+                return 0;
+            }
+            off += bigEndian(p + off, 3);
+        }
+    }
+    if (off + 3 > size) {
+        return 0;
+    }
+    uint64_t sec4 = bigEndian(p + off, 3);
+
+    if (sec4 < 120) {
+        length = (length & 0x7fffff) * 120 - sec4 + 4;
+    }
+    return length;
+}
+
+/// Length of a BUDG or TIDE pseudo-GRIB: the magic, sections 1 and 4, and "7777"
+uint64_t pseudoLength(const uint8_t* p, size_t size) {
+    uint64_t sec1 = bigEndian(p + 4, 3);
+    if (4 + sec1 + 3 > size) {
+        return 0;
+    }
+    uint64_t sec4 = bigEndian(p + 4 + sec1, 3);
+    return 4 + sec1 + sec4 + 4;
+}
+
+/// Keeps the mapping alive. Inherited first, so that it outlives the handle of the content
+struct MappingOwner {
+    std::shared_ptr<const MappedFile> file_;
+};
+
+/// A message read in place from the mapping, which is read-only. It is copied before it is first modified
+class MappedDataContent : private MappingOwner, public CodesDataContent {
+public:
+
+    MappedDataContent(std::shared_ptr<const MappedFile> file, Span<const uint8_t> bytes, eckit::Offset offset) :
+        MappingOwner{std::move(file)}, CodesDataContent(codesHandleFromMessage(bytes), offset) {}
+
+private:
+
+    void transform(const eckit::OrderedStringDict& dict) override {
+        if (file_) {
+            handle_ = codesHandleFromMessageCopy(handle_->messageData());
+            file_.reset();
+        }
+        CodesDataContent::transform(dict);
+    }
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t MappedCodesReader::messageLength(const uint8_t* p, size_t size) {
+    if (size < 16 || !isMagic(p)) {
+        return 0;
+    }
+
+    uint64_t length = 0;
+    if (std::memcmp(p, "GRIB", 4) == 0) {
+        switch (p[7]) {
+            case 1:
+                length = grib1Length(p, size);
+                break;
+            case 2:
+                length = bigEndian(p + 8, 8);
+                break;
+            default:
+                return 0;
+        }
+    }
+    else if (std::memcmp(p, "BUFR", 4) == 0) {
+        // BUFR editions 0 and 1 do not hold their length in section 0
+        if (p[7] < 2) {
+            return 0;
+        }
+        length = bigEndian(p + 4, 3);
+    }
+    else {
+        length = pseudoLength(p, size);
+    }
+
+    if (length < 16 || length > size || std::memcmp(p + length - 4, "7777", 4) != 0) {
+        return 0;
+    }
+    return length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MappedCodesReader::MappedCodesReader(const eckit::PathName& path) : file_(std::make_shared<const MappedFile>(path)) {
+    if (file_->size() > 0) {
+        ::madvise(const_cast<void*>(file_->data()), file_->size(), MADV_SEQUENTIAL);
+    }
+}
+
+MappedCodesReader::~MappedCodesReader() = default;
+
+const eckit::PathName& MappedCodesReader::path() const {
+    return file_->path();
+}
+
+size_t MappedCodesReader::size() const {
+    return file_->size();
+}
+
+Span<const uint8_t> MappedCodesReader::nextBytes(eckit::Offset& offset) {
+    const uint8_t* data = static_cast<const uint8_t*>(file_->data());
+    size_t size         = file_->size();
+
+    // Skip anything between messages
+    while (position_ + 4 <= size && !isMagic(data + position_)) {
+        ++position_;
+    }
+    if (position_ + 4 > size) {
+        position_ = size;
+        return {};
+    }
+
+    size_t start  = position_;
+    size_t length = messageLength(data + start, size - start);
+    if (length == 0) {
+        position_ = start + 4;
+        std::ostringstream oss;
+        oss << "MappedCodesReader: corrupted or truncated message at offset " << start << " of " << file_->path();
+        throw CodesWrongLength(oss.str(), Here());
+    }
+
+    position_ = start + length;
+    offset    = eckit::Offset(start);
+    return {data + start, length};
+}
+
+eckit::message::Message MappedCodesReader::next() {
+    eckit::Offset offset;
+    auto bytes = nextBytes(offset);
+    if (bytes.size() == 0) {
+        return eckit::message::Message();
+    }
+
+    return eckit::message::Message(new MappedDataContent(file_, bytes, offset));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::codes
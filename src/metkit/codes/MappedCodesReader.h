@@ -0,0 +1,75 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MappedCodesReader.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Offset.h"
+#include "eckit/message/Message.h"
+
+#include "metkit/codes/api/CodesTypes.h"
+
+namespace metkit {
+class MappedFile;
+}
+
+namespace metkit::codes {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Splits a local file of GRIB and BUFR messages, memory mapped
+///
+/// Messages are delimited from the lengths found in their first sections, without handing the bytes to ecCodes:
+/// GRIB 1 (including large messages), GRIB 2 with its 64-bit length, BUFR editions 2 and above, and the BUDG and TIDE
+/// pseudo-GRIBs. Each message is checked to end with "7777", and bytes between messages are skipped.
+///
+/// Messages are views of the mapping, which is released once the reader and all messages read are gone.
+/// nextBytes() scans a file without decoding nor copying anything; next() wraps the bytes in a handle that reads them
+/// in place.
+class MappedCodesReader {
+public:  // methods
+
+    explicit MappedCodesReader(const eckit::PathName&);
+    ~MappedCodesReader();
+
+    MappedCodesReader(const MappedCodesReader&)            = delete;
+    MappedCodesReader& operator=(const MappedCodesReader&) = delete;
+
+    /// The next message, a null message at the end of the file
+    /// @throws CodesWrongLength if a message is corrupted or truncated. Reading resumes after its first 4 bytes.
+    eckit::message::Message next();
+
+    /// The bytes of the next message and their offset in the file, an empty span at the end of the file
+    /// @throws CodesWrongLength if a message is corrupted or truncated. Reading resumes after its first 4 bytes.
+    Span<const uint8_t> nextBytes(eckit::Offset& offset);
+
+    const eckit::PathName& path() const;
+    size_t size() const;
+
+    /// Length of the message starting at data, within size bytes available, or 0 if it is not a GRIB or BUFR message
+    /// ending with "7777" within them
+    static size_t messageLength(const uint8_t* data, size_t size);
+
+private:  // members
+
+    std::shared_ptr<const MappedFile> file_;
+    size_t position_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::codes
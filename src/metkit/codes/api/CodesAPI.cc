@@ -17,6 +17,9 @@
 
 #include "metkit/config/LibMetkit.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace std {
 template <>
 struct default_delete<codes_handle> {
@@ -65,6 +68,61 @@ void throwOnError(int code, const eckit::CodeLocation& l, const char* details, c
     }
 };
 
+template <typename T>
+size_t copyArray(const std::vector<T>& values, T* data, size_t size, const char* details, const std::string& key) {
+    if (values.size() > size) {
+        throw CodesException(std::string(details) + ": array of " + std::to_string(size) + " values too small for " +
+                                 std::to_string(values.size()) + " values of key " + key,
+                             Here());
+    }
+    std::copy(values.begin(), values.end(), data);
+    return values.size();
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t CodesHandle::getDoubleArray(const std::string& key, double* data, size_t size) const {
+    return copyArray(getDoubleArray(key), data, size, "CodesHandle::getDoubleArray(string, double*, size_t)", key);
+}
+
+size_t CodesHandle::getFloatArray(const std::string& key, float* data, size_t size) const {
+    return copyArray(getFloatArray(key), data, size, "CodesHandle::getFloatArray(string, float*, size_t)", key);
+}
+
+void CodesHandle::getKeys(const KeySet& keys, KeyRecord& record) const {
+    ASSERT(&record.keySet() == &keys);
+    record.clear();
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const KeySpec& k = keys[i];
+        if (!isDefined(k.name)) {
+            if (k.onMissing == OnMissing::Skip) {
+                continue;
+            }
+            throw CodesException("CodesHandle::getKeys(KeySet): key " + k.name + " not found", Here());
+        }
+
+        switch (k.type) {
+            case NativeType::Long:
+                record.longValue(i) = getLong(k.name);
+                break;
+            case NativeType::Double:
+                record.doubleValue(i) = getDouble(k.name);
+                break;
+            default:
+                record.stringValue(i) = getString(k.name);
+                break;
+        }
+        record.set(i);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
 /// Concrete implementation of CodesHandle.
 /// ConcreteCodesHandle provides the common C++ wrapper implementation around
 /// a codes_handle* independently of the ownership model.
@@ -101,8 +159,11 @@ public:
     std::vector<long> getLongArray(const std::string& key) const override;
     std::vector<double> getDoubleArray(const std::string& key) const override;
     std::vector<float> getFloatArray(const std::string& key) const override;
+    size_t getDoubleArray(const std::string& key, double* data, size_t size) const override;
+    size_t getFloatArray(const std::string& key, float* data, size_t size) const override;
     std::vector<std::string> getStringArray(const std::string& key) const override;
     std::vector<uint8_t> getBytes(const std::string& key) const override;
+    void getKeys(const KeySet& keys, KeyRecord& record) const override;
 
     /// Clones the underyling handle.
     /// Uses `codes_handle_clone` internally.
@@ -411,23 +472,25 @@ std::vector<long> ConcreteCodesHandle::getLongArray(const std::string& key) cons
     return ret;
 }
 std::vector<double> ConcreteCodesHandle::getDoubleArray(const std::string& key) const {
-    std::vector<double> ret;
-    std::size_t ksize = size(key);
-    ret.resize(ksize);
-    throwOnError(codes_get_double_array(raw(), key.c_str(), ret.data(), &ksize), Here(),
-                 "CodesHandle::getDoubleArray(string)", key);
-    ret.resize(ksize);
+    std::vector<double> ret(size(key));
+    ret.resize(getDoubleArray(key, ret.data(), ret.size()));
     return ret;
 }
 std::vector<float> ConcreteCodesHandle::getFloatArray(const std::string& key) const {
-    std::vector<float> ret;
-    std::size_t ksize = size(key);
-    ret.resize(ksize);
-    throwOnError(codes_get_float_array(raw(), key.c_str(), ret.data(), &ksize), Here(),
-                 "CodesHandle::getFloatArray(string)", key);
-    ret.resize(ksize);
+    std::vector<float> ret(size(key));
+    ret.resize(getFloatArray(key, ret.data(), ret.size()));
     return ret;
 }
+size_t ConcreteCodesHandle::getDoubleArray(const std::string& key, double* data, size_t size) const {
+    throwOnError(codes_get_double_array(raw(), key.c_str(), data, &size), Here(),
+                 "CodesHandle::getDoubleArray(string, double*, size_t)", key);
+    return size;
+}
+size_t ConcreteCodesHandle::getFloatArray(const std::string& key, float* data, size_t size) const {
+    throwOnError(codes_get_float_array(raw(), key.c_str(), data, &size), Here(),
+                 "CodesHandle::getFloatArray(string, float*, size_t)", key);
+    return size;
+}
 std::vector<std::string> ConcreteCodesHandle::getStringArray(const std::string& key) const {
     std::vector<char*> cstrings;
     std::size_t ksize = size(key);
@@ -458,6 +521,48 @@ std::vector<uint8_t> ConcreteCodesHandle::getBytes(const std::string& key) const
     return ret;
 }
 
+/// Fetch each key with the getter of its declared type. Strings are read into the storage of the record, which
+/// keeps its capacity, and only fall back to querying the length when that storage is too small.
+void ConcreteCodesHandle::getKeys(const KeySet& keys, KeyRecord& record) const {
+    ASSERT(&record.keySet() == &keys);
+    record.clear();
+
+    codes_handle* h = raw();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const KeySpec& k = keys[i];
+        const char* name = k.name.c_str();
+
+        int err = 0;
+        switch (k.type) {
+            case NativeType::Long:
+                err = codes_get_long(h, name, &record.longValue(i));
+                break;
+            case NativeType::Double:
+                err = codes_get_double(h, name, &record.doubleValue(i));
+                break;
+            default: {
+                std::string& value = record.stringValue(i);
+                value.resize(std::max<size_t>(value.capacity(), 64));
+                size_t len = value.size();
+                err        = codes_get_string(h, name, value.data(), &len);
+                if (err == GRIB_BUFFER_TOO_SMALL) {
+                    throwOnError(codes_get_length(h, name, &len), Here(), "CodesHandle::getKeys(KeySet)", k.name);
+                    value.resize(len);
+                    err = codes_get_string(h, name, value.data(), &len);
+                }
+                value.resize(err == 0 ? strlen(value.c_str()) : 0);
+                break;
+            }
+        }
+
+        if (err == GRIB_NOT_FOUND && k.onMissing == OnMissing::Skip) {
+            continue;
+        }
+        throwOnError(err, Here(), "CodesHandle::getKeys(KeySet)", k.name);
+        record.set(i);
+    }
+}
+
 /// Cloning the whole handle. Expected to be wrapped by the user explicitly
 std::unique_ptr<CodesHandle> ConcreteCodesHandle::clone() const {
     std::unique_ptr<codes_handle> ret{codes_handle_clone(raw())};
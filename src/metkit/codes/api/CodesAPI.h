@@ -13,6 +13,7 @@
 #include "metkit/codes/api/CodesTypes.h"
 #include "metkit/codes/api/GeoIterator.h"
 #include "metkit/codes/api/KeyIterator.h"
+#include "metkit/codes/api/KeySet.h"
 
 #include "eccodes.h"
 
@@ -255,6 +256,28 @@ public:
     /// @return Retrieved values contained for the passed key.
     virtual std::vector<float> getFloatArray(const std::string& key) const = 0;
 
+    /// Decode the contained values for a key as double directly into a caller owned array.
+    ///
+    /// No memory is allocated, values are written by eccodes straight into `data`.
+    /// @param key Name of the field that is supposed to be retrieved.
+    /// @param data Pointer to an allocated array.
+    /// @param size Size of the allocated array. Should be containing at least the size returned by `size(key)`.
+    /// @return Number of values written.
+    /// @throws CodesException if the array is too small, or on any other error returned from eccodes
+    /// The default implementation copies the values returned by `getDoubleArray(key)`.
+    virtual size_t getDoubleArray(const std::string& key, double* data, size_t size) const;
+
+    /// Decode the contained values for a key as float directly into a caller owned array.
+    ///
+    /// Values are decoded to float by eccodes, without going through an array of double.
+    /// @param key Name of the field that is supposed to be retrieved.
+    /// @param data Pointer to an allocated array.
+    /// @param size Size of the allocated array. Should be containing at least the size returned by `size(key)`.
+    /// @return Number of values written.
+    /// @throws CodesException if the array is too small, or on any other error returned from eccodes
+    /// The default implementation copies the values returned by `getFloatArray(key)`.
+    virtual size_t getFloatArray(const std::string& key, float* data, size_t size) const;
+
     /// Get the contained values for a key as array of string.
     ///
     /// This should be possible for all key types.
@@ -267,6 +290,16 @@ public:
     /// @return Retrieved values contained for the passed key.
     virtual std::vector<uint8_t> getBytes(const std::string& key) const = 0;
 
+    /// Get the values of all keys of a `KeySet` at once.
+    ///
+    /// Each key is fetched as the type declared in the set, without inspecting its native type or size.
+    /// Keys the message does not define are left unset in the record, or throw, as the set specifies.
+    /// @param keys Set of keys to retrieve.
+    /// @param record Record of `keys` the values are written to. Previous values are cleared.
+    /// @throws CodesException on any error returned from eccodes, and for missing keys that are not optional
+    /// The default implementation gets the keys one by one, with `isDefined` and `getLong`, `getDouble` or `getString`.
+    virtual void getKeys(const KeySet& keys, KeyRecord& record) const;
+
     /// Clones the underyling handle.
     /// Uses `codes_handle_clone` internally.
     /// @return Unique pointer to a cloned `CodesHandle` instance.
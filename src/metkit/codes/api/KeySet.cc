@@ -0,0 +1,118 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "metkit/codes/api/KeySet.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+
+
+namespace metkit::codes {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+KeySet::KeySet(std::initializer_list<KeySpec> keys) : KeySet(std::vector<KeySpec>(keys)) {}
+
+KeySet::KeySet(std::vector<KeySpec> keys) : keys_(std::move(keys)) {
+    offsets_.reserve(keys_.size());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        const auto& k = keys_[i];
+
+        if (!index_.emplace(k.name, i).second) {
+            throw eckit::UserError("KeySet: key " + k.name + " is given twice", Here());
+        }
+
+        switch (k.type) {
+            case NativeType::Long:
+                offsets_.push_back(countLongs_++);
+                break;
+            case NativeType::Double:
+                offsets_.push_back(countDoubles_++);
+                break;
+            case NativeType::String:
+                offsets_.push_back(countStrings_++);
+                break;
+            default: {
+                std::ostringstream oss;
+                oss << "KeySet: key " << k.name << " must be fetched as a long, a double or a string";
+                throw eckit::UserError(oss.str(), Here());
+            }
+        }
+    }
+}
+
+std::optional<size_t> KeySet::index(const std::string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t KeySet::at(const std::string& name) const {
+    auto i = index(name);
+    if (!i) {
+        throw eckit::UserError("KeySet: no key " + name, Here());
+    }
+    return *i;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+KeyRecord::KeyRecord(const KeySet& keys) :
+    keys_(keys),
+    present_(keys.size(), 0),
+    longs_(keys.countLongs()),
+    doubles_(keys.countDoubles()),
+    strings_(keys.countStrings()) {}
+
+void KeyRecord::clear() {
+    std::fill(present_.begin(), present_.end(), 0);
+}
+
+void KeyRecord::check(size_t i, NativeType type) const {
+    ASSERT(i < keys_.size());
+    ASSERT(keys_[i].type == type);
+    if (!present_[i]) {
+        throw eckit::UserError("KeyRecord: no value for key " + keys_[i].name, Here());
+    }
+}
+
+long KeyRecord::getLong(size_t i) const {
+    check(i, NativeType::Long);
+    return longs_[keys_.offset(i)];
+}
+
+double KeyRecord::getDouble(size_t i) const {
+    check(i, NativeType::Double);
+    return doubles_[keys_.offset(i)];
+}
+
+const std::string& KeyRecord::getString(size_t i) const {
+    check(i, NativeType::String);
+    return strings_[keys_.offset(i)];
+}
+
+CodesValue KeyRecord::get(size_t i) const {
+    switch (keys_[i].type) {
+        case NativeType::Long:
+            return getLong(i);
+        case NativeType::Double:
+            return getDouble(i);
+        default:
+            return getString(i);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::codes
@@ -0,0 +1,141 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#pragma once
+
+#include "metkit/codes/api/CodesTypes.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace metkit::codes {
+
+class CodesHandle;
+class KeyRecord;
+
+/// Policy applied when a message does not define a key of a `KeySet`.
+enum class OnMissing {
+    /// Throw a `CodesException`.
+    Throw,
+    /// Leave the key unset in the record.
+    Skip,
+};
+
+
+/// Description of a key fetched through a `KeySet`.
+struct KeySpec {
+    std::string name;
+
+    /// Type the key is fetched as. Only `Long`, `Double` and `String` are supported.
+    NativeType type = NativeType::String;
+
+    OnMissing onMissing = OnMissing::Throw;
+};
+
+
+/// A list of keys compiled once, and fetched at once from many messages with `CodesHandle::getKeys`.
+///
+/// Each key is fetched as the type it is declared with, without querying its native type or its size, into a slot of
+/// a `KeyRecord`. Slots are numbered in the order of the keys, and values of the same type are packed together.
+///
+/// A `KeySet` is immutable and can be shared between threads. Each thread fills its own `KeyRecord`.
+class KeySet {
+public:
+
+    KeySet(std::vector<KeySpec> keys);
+    KeySet(std::initializer_list<KeySpec> keys);
+
+    /// Number of keys.
+    size_t size() const { return keys_.size(); }
+
+    const KeySpec& operator[](size_t i) const { return keys_[i]; }
+
+    /// Slot of a key, if it is part of the set.
+    std::optional<size_t> index(const std::string& name) const;
+
+    /// Slot of a key.
+    /// @throws eckit::UserError if the key is not part of the set.
+    size_t at(const std::string& name) const;
+
+    size_t countLongs() const { return countLongs_; }
+    size_t countDoubles() const { return countDoubles_; }
+    size_t countStrings() const { return countStrings_; }
+
+    /// Position of the value of a key amongst the values of its type.
+    size_t offset(size_t i) const { return offsets_[i]; }
+
+private:
+
+    std::vector<KeySpec> keys_;
+    std::vector<size_t> offsets_;
+    std::unordered_map<std::string, size_t> index_;
+
+    size_t countLongs_   = 0;
+    size_t countDoubles_ = 0;
+    size_t countStrings_ = 0;
+};
+
+
+/// Values of the keys of a `KeySet` fetched from one message.
+///
+/// A record is filled by `CodesHandle::getKeys`, and is meant to be reused from one message to the next: strings keep
+/// their capacity, so that filling a record does not allocate once it has seen the longest values.
+class KeyRecord {
+public:
+
+    explicit KeyRecord(const KeySet& keys);
+
+    const KeySet& keySet() const { return keys_; }
+
+    /// Whether a value was fetched for the key of a slot.
+    bool has(size_t i) const { return present_[i]; }
+
+    /// Value of a slot, which must have been declared with that type.
+    /// @throws eckit::UserError if the slot holds no value.
+    long getLong(size_t i) const;
+    double getDouble(size_t i) const;
+    const std::string& getString(size_t i) const;
+
+    /// Value of a slot as a sum type.
+    CodesValue get(size_t i) const;
+
+    /// Marks all slots as unset.
+    void clear();
+
+public:  // for CodesHandle implementations filling the record
+
+    /// Storage of the value of a slot
+    long& longValue(size_t i) { return longs_[keys_.offset(i)]; }
+    double& doubleValue(size_t i) { return doubles_[keys_.offset(i)]; }
+    std::string& stringValue(size_t i) { return strings_[keys_.offset(i)]; }
+
+    /// Marks a slot as holding a value
+    void set(size_t i) { present_[i] = true; }
+
+private:
+
+    void check(size_t i, NativeType type) const;
+
+private:
+
+    const KeySet& keys_;
+
+    std::vector<uint8_t> present_;
+    std::vector<long> longs_;
+    std::vector<double> doubles_;
+    std::vector<std::string> strings_;
+};
+
+}  // namespace metkit::codes
@@ -0,0 +1,294 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ConfigSnapshot.cc
+/// @date   Oct 2026
+
+#include "metkit/config/ConfigSnapshot.h"
+
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/parser/YAMLParser.h"
+#include "eckit/serialisation/FileStream.h"
+#include "eckit/serialisation/MemoryStream.h"
+
+#include "metkit/config/LibMetkit.h"
+#include "metkit/utils/MappedFile.h"
+
+namespace metkit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const std::string magic = "METKIT-CONFIG-SNAPSHOT";
+
+/// Bump when the encoding below changes, older snapshots are then ignored
+constexpr long formatVersion = 1;
+
+enum Tag : int {
+    NIL         = 0,
+    BOOL        = 1,
+    NUMBER      = 2,
+    DOUBLE      = 3,
+    STRING      = 4,
+    LIST        = 5,
+    MAP         = 6,
+    ORDERED_MAP = 7,
+};
+
+void encode(eckit::Stream& s, const eckit::Value& v) {
+    if (v.isNil()) {
+        s << int(NIL);
+    }
+    else if (v.isBool()) {
+        s << int(BOOL) << bool(v);
+    }
+    else if (v.isNumber()) {
+        s << int(NUMBER) << static_cast<long long>(v);
+    }
+    else if (v.isDouble()) {
+        s << int(DOUBLE) << double(v);
+    }
+    else if (v.isString()) {
+        s << int(STRING) << std::string(v);
+    }
+    else if (v.isList()) {
+        s << int(LIST) << static_cast<long long>(v.size());
+        for (size_t i = 0; i < v.size(); ++i) {
+            encode(s, v[i]);
+        }
+    }
+    else if (v.isMap() || v.isOrderedMap()) {
+        eckit::Value keys = v.keys();
+        s << int(v.isOrderedMap() ? ORDERED_MAP : MAP) << static_cast<long long>(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            encode(s, keys[i]);
+            encode(s, v[keys[i]]);
+        }
+    }
+    else {
+        std::ostringstream oss;
+        oss << "ConfigSnapshot: cannot encode value " << v;
+        throw eckit::SeriousBug(oss.str());
+    }
+}
+
+eckit::Value decode(eckit::Stream& s) {
+    int tag;
+    s >> tag;
+    switch (tag) {
+        case NIL:
+            return eckit::Value();
+        case BOOL: {
+            bool b;
+            s >> b;
+            return eckit::Value(b);
+        }
+        case NUMBER: {
+            long long n;
+            s >> n;
+            return eckit::Value(n);
+        }
+        case DOUBLE: {
+            double d;
+            s >> d;
+            return eckit::Value(d);
+        }
+        case STRING: {
+            std::string str;
+            s >> str;
+            return eckit::Value(str);
+        }
+        case LIST: {
+            long long n;
+            s >> n;
+            eckit::Value list = eckit::Value::makeList();
+            for (long long i = 0; i < n; ++i) {
+                list.append(decode(s));
+            }
+            return list;
+        }
+        case MAP:
+        case ORDERED_MAP: {
+            long long n;
+            s >> n;
+            eckit::Value map = (tag == MAP) ? eckit::Value::makeMap() : eckit::Value::makeOrderedMap();
+            for (long long i = 0; i < n; ++i) {
+                eckit::Value key = decode(s);
+                map[key]         = decode(s);
+            }
+            return map;
+        }
+        default: {
+            std::ostringstream oss;
+            oss << "ConfigSnapshot: invalid tag " << tag;
+            throw eckit::SeriousBug(oss.str());
+        }
+    }
+}
+
+struct Header {
+    long version        = 0;
+    long long size      = -1;
+    long long timestamp = -1;
+
+    static Header of(const eckit::PathName& yaml) {
+        Header h;
+        h.version   = formatVersion;
+        h.size      = static_cast<long long>(yaml.size());
+        h.timestamp = static_cast<long long>(yaml.lastModified());
+        return h;
+    }
+
+    void encode(eckit::Stream& s) const { s << magic << version << size << timestamp; }
+
+    void decode(eckit::Stream& s) {
+        std::string m;
+        s >> m;
+        if (m != magic) {
+            throw eckit::BadValue("ConfigSnapshot: not a metkit configuration snapshot");
+        }
+        s >> version >> size >> timestamp;
+    }
+
+    bool operator==(const Header& other) const {
+        return version == other.version && size == other.size && timestamp == other.timestamp;
+    }
+};
+
+const std::string& snapshotDir() {
+    static std::string dir = eckit::Resource<std::string>("metkitConfigSnapshotDir;$METKIT_CONFIG_SNAPSHOT_DIR", "");
+    return dir;
+}
+
+bool useSnapshots() {
+    static bool use = eckit::Resource<bool>("metkitConfigSnapshot;$METKIT_CONFIG_SNAPSHOT", true);
+    return use;
+}
+
+void write(const eckit::PathName& snapshot, const Header& header, const eckit::Value& value) {
+    snapshot.dirName().mkdir();
+
+    // write to a temporary file then rename, so that concurrent readers never see a partial snapshot
+    std::ostringstream tmp;
+    tmp << snapshot << ".tmp." << ::getpid();
+    eckit::PathName tmpPath(tmp.str());
+    {
+        eckit::FileStream s(tmpPath, "w");
+        header.encode(s);
+        encode(s, value);
+        s.close();
+    }
+    eckit::PathName::rename(tmpPath, snapshot);
+}
+
+/// Maps the snapshot once, and decodes it only if its header matches the YAML file
+bool loadIfFresh(const eckit::PathName& yaml, const eckit::PathName& snapshot, eckit::Value& value) {
+    if (!snapshot.exists()) {
+        return false;
+    }
+    MappedFile file(snapshot);
+    eckit::MemoryStream s(file.data(), file.size());
+    try {
+        Header h;
+        h.decode(s);
+        if (!(h == Header::of(yaml))) {
+            return false;
+        }
+    }
+    catch (std::exception& e) {
+        LOG_DEBUG_LIB(LibMetkit) << "ConfigSnapshot: ignoring " << snapshot << ": " << e.what() << std::endl;
+        return false;
+    }
+    LOG_DEBUG_LIB(LibMetkit) << "ConfigSnapshot: loading " << snapshot << std::endl;
+    value = decode(s);
+    return true;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+eckit::PathName ConfigSnapshot::snapshotFile(const eckit::PathName& yaml) {
+    if (snapshotDir().empty()) {
+        return yaml + ".bin";
+    }
+    return eckit::PathName(snapshotDir()) / (yaml.baseName() + ".bin");
+}
+
+bool ConfigSnapshot::fresh(const eckit::PathName& yaml, const eckit::PathName& snapshot) {
+    if (!snapshot.exists()) {
+        return false;
+    }
+    try {
+        MappedFile file(snapshot);
+        eckit::MemoryStream s(file.data(), file.size());
+        Header h;
+        h.decode(s);
+        return h == Header::of(yaml);
+    }
+    catch (std::exception& e) {
+        LOG_DEBUG_LIB(LibMetkit) << "ConfigSnapshot: ignoring " << snapshot << ": " << e.what() << std::endl;
+    }
+    return false;
+}
+
+void ConfigSnapshot::compile(const eckit::PathName& yaml, const eckit::PathName& snapshot) {
+    LOG_DEBUG_LIB(LibMetkit) << "ConfigSnapshot: compiling " << yaml << " into " << snapshot << std::endl;
+
+    Header header = Header::of(yaml);
+    write(snapshot, header, eckit::YAMLParser::decodeFile(yaml));
+}
+
+eckit::Value ConfigSnapshot::load(const eckit::PathName& snapshot) {
+    MappedFile file(snapshot);
+    eckit::MemoryStream s(file.data(), file.size());
+    Header h;
+    h.decode(s);
+    return decode(s);
+}
+
+eckit::Value ConfigSnapshot::decodeFile(const eckit::PathName& yaml) {
+
+    if (useSnapshots()) {
+        eckit::PathName snapshot = snapshotFile(yaml);
+        try {
+            eckit::Value value;
+            if (loadIfFresh(yaml, snapshot, value)) {
+                return value;
+            }
+            if (!snapshotDir().empty()) {
+                // the freshly parsed value is returned as is, there is no need to read the snapshot back
+                LOG_DEBUG_LIB(LibMetkit) << "ConfigSnapshot: compiling " << yaml << " into " << snapshot << std::endl;
+                Header header = Header::of(yaml);
+                value         = eckit::YAMLParser::decodeFile(yaml);
+                write(snapshot, header, value);
+                return value;
+            }
+        }
+        catch (std::exception& e) {
+            eckit::Log::warning() << "ConfigSnapshot: cannot use " << snapshot << ", parsing " << yaml << ": "
+                                  << e.what() << std::endl;
+        }
+    }
+
+    return eckit::YAMLParser::decodeFile(yaml);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit
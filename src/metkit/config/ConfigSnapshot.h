@@ -0,0 +1,54 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ConfigSnapshot.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/value/Value.h"
+
+namespace metkit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Binary snapshots of the YAML configuration files (language, modifiers, params, paramids, ...)
+///
+/// A snapshot holds the decoded eckit::Value tree of one YAML file, together with the size and modification time of
+/// the file it was compiled from. Snapshots are memory mapped and decoded without going through the YAML parser.
+/// This is a cached decode, not a zero-copy image: loading a snapshot still builds the full eckit::Value tree, it only
+/// saves parsing the YAML. Each load maps the snapshot once, and checks its header before decoding the rest.
+/// A snapshot that does not match its YAML file (or an older snapshot format) is ignored, and the YAML is parsed.
+///
+/// Snapshots are looked up next to the YAML file (@c language.yaml.bin), or in $METKIT_CONFIG_SNAPSHOT_DIR when set.
+/// In the latter case, missing or stale snapshots are (re)compiled on demand.
+class ConfigSnapshot {
+public:  // methods
+
+    /// Decodes a YAML configuration file, from its snapshot when a fresh one is available
+    static eckit::Value decodeFile(const eckit::PathName& yaml);
+
+    /// Compiles a YAML configuration file into a snapshot
+    static void compile(const eckit::PathName& yaml, const eckit::PathName& snapshot);
+
+    /// Decodes a snapshot, without checking it against its YAML file
+    static eckit::Value load(const eckit::PathName& snapshot);
+
+    /// Location of the snapshot of the given YAML file
+    static eckit::PathName snapshotFile(const eckit::PathName& yaml);
+
+    /// True if the snapshot exists and was compiled from the current version of the YAML file
+    static bool fresh(const eckit::PathName& yaml, const eckit::PathName& snapshot);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit
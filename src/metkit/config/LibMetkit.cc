@@ -80,6 +80,17 @@ eckit::PathName LibMetkit::paramMatchingYamlFile() {
 eckit::PathName LibMetkit::bufrSubtypesYamlFile() {
     return LibMetkit::configFile("bufr-subtypes.yaml");
 }
+std::vector<eckit::PathName> LibMetkit::languageConfigFiles() {
+    std::vector<eckit::PathName> files{languageYamlFile()};
+    for (const auto& file : modifiersYamlFiles()) {
+        files.push_back(file);
+    }
+    files.push_back(paramIDYamlFile());
+    files.push_back(paramYamlFile());
+    files.push_back(paramStaticYamlFile());
+    files.push_back(shortnameContextYamlFile());
+    return files;
+}
 
 }  // namespace metkit
 
@@ -38,6 +38,9 @@ public:
     static eckit::PathName shortnameContextYamlFile();
     static eckit::PathName bufrSubtypesYamlFile();
 
+    /// YAML files read when building the MARS language, candidates for a ConfigSnapshot
+    static std::vector<eckit::PathName> languageConfigFiles();
+
     static const LibMetkit& instance();
 
 protected:
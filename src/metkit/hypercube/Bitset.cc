@@ -0,0 +1,244 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   Bitset.cc
+/// @date   Oct 2026
+
+#include "metkit/hypercube/Bitset.h"
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace metkit::hypercube {
+
+namespace {
+
+uint64_t mask(size_t n) {
+    return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Bitset::Bitset(size_t size, bool value) : size_(size), words_((size + 63) / 64, value ? ~uint64_t(0) : 0) {
+    if (value && size % 64) {
+        words_.back() = mask(size % 64);
+    }
+    index();
+}
+
+Bitset::Bitset(size_t size, std::vector<uint64_t> words) : size_(size), words_(std::move(words)) {
+    ASSERT(words_.size() == (size + 63) / 64);
+    if (size % 64) {
+        words_.back() &= mask(size % 64);
+    }
+    index();
+}
+
+void Bitset::index() {
+    const size_t blocks = (size_ + blockBits_ - 1) / blockBits_;
+
+    count_ = 0;
+    tree_.assign(blocks + 1, 0);
+
+    for (size_t b = 1; b <= blocks; ++b) {
+        size_t n   = 0;
+        size_t end = std::min(b * blockWords_, words_.size());
+        for (size_t w = (b - 1) * blockWords_; w < end; ++w) {
+            n += __builtin_popcountll(words_[w]);
+        }
+        tree_[b] += n;
+        count_ += n;
+
+        size_t parent = b + (b & -b);
+        if (parent <= blocks) {
+            tree_[parent] += tree_[b];
+        }
+    }
+}
+
+bool Bitset::set(size_t i) {
+    uint64_t bit = uint64_t(1) << (i % 64);
+    if (words_[i / 64] & bit) {
+        return false;
+    }
+    words_[i / 64] |= bit;
+    update(i / blockBits_, true);
+    return true;
+}
+
+bool Bitset::reset(size_t i) {
+    uint64_t bit = uint64_t(1) << (i % 64);
+    if (!(words_[i / 64] & bit)) {
+        return false;
+    }
+    words_[i / 64] &= ~bit;
+    update(i / blockBits_, false);
+    return true;
+}
+
+void Bitset::update(size_t block, bool increment) {
+    increment ? ++count_ : --count_;
+    for (size_t b = block + 1; b < tree_.size(); b += b & -b) {
+        increment ? ++tree_[b] : --tree_[b];
+    }
+}
+
+size_t Bitset::prefix(size_t block) const {
+    size_t n = 0;
+    for (size_t b = block; b > 0; b -= b & -b) {
+        n += tree_[b];
+    }
+    return n;
+}
+
+size_t Bitset::rank(size_t i) const {
+    ASSERT(i <= size_);
+
+    size_t block = i / blockBits_;
+    size_t n     = prefix(block);
+    for (size_t w = block * blockWords_; w < i / 64; ++w) {
+        n += __builtin_popcountll(words_[w]);
+    }
+    if (i % 64) {
+        n += __builtin_popcountll(words_[i / 64] & mask(i % 64));
+    }
+    return n;
+}
+
+size_t Bitset::select(size_t n, bool value) const {
+    ASSERT(n < (value ? count_ : size_ - count_));
+
+    // find the block, descending the Fenwick tree
+    const size_t blocks = tree_.size() - 1;
+    size_t step         = 1;
+    while (step * 2 <= blocks) {
+        step *= 2;
+    }
+
+    size_t block = 0;
+    for (; step > 0; step /= 2) {
+        size_t next = block + step;
+        if (next > blocks) {
+            continue;
+        }
+        size_t ones = tree_[next];
+        size_t bits = std::min(next * blockBits_, size_) - block * blockBits_;
+        size_t c    = value ? ones : bits - ones;
+        if (c <= n) {
+            block = next;
+            n -= c;
+        }
+    }
+
+    // then the word, and the bit within it
+    for (size_t w = block * blockWords_; w < words_.size(); ++w) {
+        uint64_t word = value ? words_[w] : ~words_[w];
+        if (w + 1 == words_.size() && size_ % 64) {
+            word &= mask(size_ % 64);
+        }
+        size_t c = __builtin_popcountll(word);
+        if (n < c) {
+            for (; n > 0; --n) {
+                word &= word - 1;
+            }
+            return w * 64 + __builtin_ctzll(word);
+        }
+        n -= c;
+    }
+
+    throw eckit::SeriousBug("Bitset::select out of range");
+}
+
+size_t Bitset::count(size_t begin, size_t length) const {
+    ASSERT(begin + length <= size_);
+
+    size_t n   = 0;
+    size_t pos = begin;
+    size_t end = begin + length;
+
+    // leading partial word
+    if (pos % 64 && pos < end) {
+        size_t take = std::min<size_t>(64 - pos % 64, end - pos);
+        n += __builtin_popcountll((words_[pos / 64] >> (pos % 64)) & mask(take));
+        pos += take;
+    }
+
+    for (; pos + 64 <= end; pos += 64) {
+        n += __builtin_popcountll(words_[pos / 64]);
+    }
+
+    if (pos < end) {
+        n += __builtin_popcountll(words_[pos / 64] & mask(end - pos));
+    }
+
+    return n;
+}
+
+uint64_t Bitset::bits(size_t pos) const {
+    size_t w      = pos / 64;
+    size_t offset = pos % 64;
+
+    if (w >= words_.size()) {
+        return 0;
+    }
+
+    uint64_t out = words_[w] >> offset;
+    if (offset && w + 1 < words_.size()) {
+        out |= words_[w + 1] << (64 - offset);
+    }
+    return out;
+}
+
+size_t Bitset::hash(size_t begin, size_t length) const {
+    uint64_t h = 14695981039346656037ULL ^ length;
+    for (size_t i = 0; i < length; i += 64) {
+        uint64_t b = bits(begin + i) & mask(length - i);
+        h ^= b + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool Bitset::equal(size_t a, size_t b, size_t length) const {
+    for (size_t i = 0; i < length; i += 64) {
+        uint64_t m = mask(length - i);
+        if ((bits(a + i) & m) != (bits(b + i) & m)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+AtomicBitset::AtomicBitset(size_t size, bool value) :
+    size_(size), words_(new std::atomic<uint64_t>[(size + 63) / 64]), count_(value ? size : 0) {
+    const size_t n = (size + 63) / 64;
+    for (size_t w = 0; w < n; ++w) {
+        words_[w].store(value ? ~uint64_t(0) : 0, std::memory_order_relaxed);
+    }
+    if (value && size % 64) {
+        words_[n - 1].store(mask(size % 64), std::memory_order_relaxed);
+    }
+}
+
+Bitset AtomicBitset::snapshot() const {
+    std::vector<uint64_t> words((size_ + 63) / 64);
+    for (size_t w = 0; w < words.size(); ++w) {
+        words[w] = words_[w].load(std::memory_order_acquire);
+    }
+    return Bitset(size_, std::move(words));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::hypercube
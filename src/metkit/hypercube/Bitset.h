@@ -0,0 +1,146 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   Bitset.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace metkit::hypercube {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Fixed-size set of bits packed in 64-bit words, with the range operations used to cover a HyperCube
+///
+/// The number of bits set in each block of 512 bits is kept in a Fenwick tree, so that rank() and select() do not
+/// scan the bitset and set() and reset() stay cheap: both take O(log(size / 512)) word operations.
+class Bitset {
+public:  // methods
+
+    Bitset() = default;
+    Bitset(size_t size, bool value);
+
+    /// From the words of another bitset, e.g. a snapshot of an AtomicBitset
+    Bitset(size_t size, std::vector<uint64_t> words);
+
+    size_t size() const { return size_; }
+
+    bool test(size_t i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+    bool operator[](size_t i) const { return test(i); }
+
+    /// Sets bit i, returns false if it was already set
+    bool set(size_t i);
+    /// Clears bit i, returns false if it was already clear
+    bool reset(size_t i);
+
+    /// Number of bits set
+    size_t count() const { return count_; }
+
+    /// Number of bits set in [begin, begin + length)
+    size_t count(size_t begin, size_t length) const;
+
+    /// The 64 bits starting at pos, padded with zeros past the end
+    uint64_t bits(size_t pos) const;
+
+    /// Hash of the bits in [begin, begin + length), equal for equal ranges
+    size_t hash(size_t begin, size_t length) const;
+
+    /// Whether [a, a + length) and [b, b + length) hold the same bits
+    bool equal(size_t a, size_t b, size_t length) const;
+
+    /// Number of bits set in [0, i)
+    size_t rank(size_t i) const;
+
+    /// Position of the bit equal to value with n bits equal to value before it
+    size_t select(size_t n, bool value = true) const;
+
+    /// Calls f(i) for each bit i equal to value, in increasing order
+    template <typename F>
+    void forEach(bool value, F f) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            uint64_t word = value ? words_[w] : ~words_[w];
+            if (w + 1 == words_.size() && size_ % 64) {
+                word &= (uint64_t(1) << (size_ % 64)) - 1;
+            }
+            for (; word; word &= word - 1) {
+                f(w * 64 + __builtin_ctzll(word));
+            }
+        }
+    }
+
+    const std::vector<uint64_t>& words() const { return words_; }
+
+private:  // methods
+
+    /// Builds the count and the tree from the words
+    void index();
+
+    void update(size_t block, bool increment);
+
+    /// Number of bits set in the blocks [0, block)
+    size_t prefix(size_t block) const;
+
+private:  // members
+
+    static constexpr size_t blockBits_  = 512;
+    static constexpr size_t blockWords_ = blockBits_ / 64;
+
+    size_t size_  = 0;
+    size_t count_ = 0;
+    std::vector<uint64_t> words_;
+    std::vector<size_t> tree_;  // Fenwick tree of the number of bits set per block, 1-based
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Fixed-size set of bits in atomic 64-bit words, which threads can test and clear without locking
+class AtomicBitset {
+public:  // methods
+
+    AtomicBitset(size_t size, bool value);
+
+    size_t size() const { return size_; }
+
+    bool test(size_t i) const {
+        return (words_[i / 64].load(std::memory_order_acquire) >> (i % 64)) & 1;
+    }
+
+    /// Clears bit i, returns false if it was already clear (e.g. cleared by another thread)
+    bool reset(size_t i) {
+        uint64_t bit = uint64_t(1) << (i % 64);
+        if (!(words_[i / 64].fetch_and(~bit, std::memory_order_acq_rel) & bit)) {
+            return false;
+        }
+        count_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Number of bits set
+    size_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    /// Copy of the bits. With concurrent resets, each bit is taken at some point during the call
+    Bitset snapshot() const;
+
+private:  // members
+
+    size_t size_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    std::atomic<size_t> count_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::hypercube
@@ -0,0 +1,35 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ConcurrentHyperCube.cc
+/// @date   Oct 2026
+
+#include "metkit/hypercube/ConcurrentHyperCube.h"
+
+namespace metkit::hypercube {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ConcurrentHyperCube::ConcurrentHyperCube(const metkit::mars::MarsRequest& request) :
+    HyperCube(request, AxesOnly{}), fields_(size(), true) {}
+
+bool ConcurrentHyperCube::contains(const metkit::mars::MarsRequest& r) const {
+    int idx = indexOf(r);
+    return idx >= 0 && fields_.test(idx);
+}
+
+bool ConcurrentHyperCube::clear(const metkit::mars::MarsRequest& r) {
+    int idx = indexOf(r);
+    return idx >= 0 && fields_.reset(idx);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::hypercube
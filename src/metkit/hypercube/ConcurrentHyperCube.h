@@ -0,0 +1,57 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ConcurrentHyperCube.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <vector>
+
+#include "metkit/hypercube/Bitset.h"
+#include "metkit/hypercube/HyperCube.h"
+
+namespace metkit::hypercube {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief HyperCube whose fields can be cleared by many threads at once
+///
+/// contains() and clear() do not lock, and countVacant() is exact at any time. vacantRequests() and requests() work
+/// on a snapshot of the fields, so a monitor thread can call them while producers keep clearing fields: every field
+/// cleared before the call is left out of the vacant requests.
+class ConcurrentHyperCube : private HyperCube {
+public:  // methods
+
+    explicit ConcurrentHyperCube(const metkit::mars::MarsRequest&);
+
+    bool contains(const metkit::mars::MarsRequest&) const;
+
+    /// Returns true if this call cleared the field, false if it was not in the cube or already cleared
+    bool clear(const metkit::mars::MarsRequest&);
+
+    size_t countVacant() const { return fields_.count(); }
+    using HyperCube::size;
+
+    std::vector<metkit::mars::MarsRequest> vacantRequests(bool compact = false) const {
+        return aggregatedRequests(fields_.snapshot(), true, compact);
+    }
+    std::vector<metkit::mars::MarsRequest> requests(bool compact = false) const {
+        return aggregatedRequests(fields_.snapshot(), false, compact);
+    }
+
+private:  // members
+
+    AtomicBitset fields_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::hypercube
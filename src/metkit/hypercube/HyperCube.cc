@@ -11,10 +11,14 @@
 #include "metkit/hypercube/HyperCube.h"
 
 #include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/parser/YAMLParser.h"
 
+#include "metkit/hypercube/HyperCubeFile.h"
 #include "metkit/mars/MarsLanguage.h"
 #include "metkit/mars/MarsRequest.h"
 #include "metkit/mars/Type.h"
@@ -48,18 +52,25 @@ AxisOrder& AxisOrder::instance() {
 class Axis {
 public:
 
-    Axis(const std::string& name, const std::vector<std::string>& values) : name_(name), values_(values) {}
+    Axis(const std::string& name, const std::vector<std::string>& values) : name_(name), values_(values) {
+        index_.reserve(values_.size());
+        for (size_t i = 0; i < values_.size(); ++i) {
+            index_.emplace(values_[i], i);  // the first of duplicate values wins
+        }
+    }
 
     size_t size() const { return values_.size(); }
 
     const std::string& name() const { return name_; }
 
+    const std::vector<std::string>& values() const { return values_; }
+
     int indexOf(const std::string& v) const {
-        auto j = std::find(values_.begin(), values_.end(), v);
-        if (j == values_.end()) {
+        auto j = index_.find(v);
+        if (j == index_.end()) {
             return -1;
         }
-        return j - values_.begin();
+        return j->second;
     }
 
     const std::string& valueOf(size_t index) const {
@@ -83,10 +94,16 @@ private:
 
     std::string name_;
     std::vector<std::string> values_;
+    std::unordered_map<std::string, int> index_;
 };
 
-HyperCube::HyperCube(const metkit::mars::MarsRequest& request) :
-    verb_(request.verb()), cube_(std::vector<eckit::Ordinal>()) {
+HyperCube::HyperCube(const metkit::mars::MarsRequest& request) : HyperCube(request, AxesOnly{}) {
+    count_ = cube_.count();
+    set_   = Bitset(count_, true);
+}
+
+HyperCube::HyperCube(const metkit::mars::MarsRequest& request, AxesOnly) :
+    verb_(request.verb()), cube_(std::vector<eckit::Ordinal>()), count_(0) {
 
     std::vector<eckit::Ordinal> dimensions;
 
@@ -101,9 +118,13 @@ HyperCube::HyperCube(const metkit::mars::MarsRequest& request) :
         }
     }
 
-    cube_  = eckit::HyperCube(dimensions);
-    count_ = cube_.count();
-    set_   = std::vector<bool>(count_, true);
+    cube_ = eckit::HyperCube(dimensions);
+}
+
+HyperCube::HyperCube(const HyperCubeFile& file) : HyperCube(file.axes(), AxesOnly{}) {
+    ASSERT(cube_.count() == file.size());
+    set_   = file.fields();
+    count_ = set_.count();
 }
 
 HyperCube::~HyperCube() {
@@ -112,6 +133,10 @@ HyperCube::~HyperCube() {
     }
 }
 
+void HyperCube::save(const eckit::PathName& path) const {
+    HyperCubeFile::write(path, *this);
+}
+
 bool HyperCube::contains(const metkit::mars::MarsRequest& r) const {
     int idx = indexOf(r);
     return (idx >= 0) and set_[idx];
@@ -120,9 +145,8 @@ bool HyperCube::contains(const metkit::mars::MarsRequest& r) const {
 bool HyperCube::clear(int idx) {
     if (idx < 0)
         return false;
-    if (!set_[idx])
+    if (!set_.reset(idx))
         return false;
-    set_[idx] = false;
     count_--;
     return true;
 }
@@ -160,143 +184,204 @@ int HyperCube::indexOf(const metkit::mars::MarsRequest& r) const {
     return cube_.index(coords);
 }
 
-enum requestRelation {
-    EMBEDDED,
-    ADJACENT,
-    DISJOINT
-};
+namespace {
 
-requestRelation getRelation(const metkit::mars::MarsRequest& base, const size_t& baseSize,
-                            const metkit::mars::MarsRequest& additional, const size_t additionalSize) {
+/// A request in coordinates: for each axis, the indices of its values
+using Box = std::vector<std::vector<eckit::Ordinal>>;
 
-    metkit::mars::MarsRequest tmp(base);
-    tmp.merge(additional);  // creates the bounding box request
+/// Covers the bits of a Bitset equal to a value with as few boxes as possible, the bits being the cells of a
+/// cube laid out in mixed radix. The cube is split along the axes from the slowest varying one: a sub-cube whose bits
+/// are all equal to the value is a box, and slices with identical bits are covered together.
+class Cover {
+public:
 
-    /// @todo: building a hypercube *JUST* to get the size? Seems like we can do better
-    size_t sizeAfter = tmp.count();
+    Cover(const Bitset& bits, bool value, const std::vector<eckit::Ordinal>& dimensions,
+          const std::vector<eckit::Ordinal>& strides) :
+        bits_(bits), value_(value), dimensions_(dimensions), strides_(strides), order_(dimensions.size()) {
 
-    if (sizeAfter == baseSize)
-        return requestRelation::EMBEDDED;
+        std::iota(order_.begin(), order_.end(), 0);
+        std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) { return strides_[a] > strides_[b]; });
 
-    if (baseSize + additionalSize == sizeAfter)
-        return requestRelation::ADJACENT;
+        lengths_.resize(order_.size() + 1, 1);
+        for (size_t l = order_.size(); l > 0; --l) {
+            lengths_[l - 1] = lengths_[l] * dimensions_[order_[l - 1]];
+            ASSERT(dimensions_[order_[l - 1]] == 1 || strides_[order_[l - 1]] == lengths_[l]);
+        }
+        ASSERT(lengths_[0] == bits_.size());
+    }
 
-    return requestRelation::DISJOINT;
-}
+    std::vector<Box> boxes() {
+        std::vector<Box> out;
+        Box box(dimensions_.size());
+        cover(0, 0, box, out);
+        merge(out);
+        return out;
+    }
 
-// Returns true only if the last request was merged into an adjacent
-bool mergeLast(std::vector<std::pair<metkit::mars::MarsRequest, size_t>>& requests) {
-    size_t last = requests.size() - 1;
+private:
 
-    size_t candidateIdx  = std::numeric_limits<size_t>::max();
-    size_t candidateSize = 0;
+    struct Slices {
+        std::vector<eckit::Ordinal> values;
+        size_t offset;
+    };
 
-    // check if the new request is embedded or adjacent to existing requests
-    for (size_t j = 0; j < requests.size() - 1; j++) {
-        requestRelation relation =
-            getRelation(requests[j].first, requests[j].second, requests[last].first, requests[last].second);
-        if (relation == requestRelation::EMBEDDED) {
-            requests.pop_back();
-            return false;
-        }
-        if (relation == requestRelation::ADJACENT) {
-            // We can merge the two requests
-            // Though we will only merge with the largest adjacent request, so dont merge yet.
-            size_t combinedSize = requests[j].second + requests[last].second;
-            if (candidateSize < combinedSize) {
-                candidateIdx  = j;
-                candidateSize = combinedSize;
-            }
-        }
+    size_t count(size_t offset, size_t length) const {
+        size_t n = bits_.count(offset, length);
+        return value_ ? n : length - n;
     }
 
-    // Merge with the largest adjacent request if one was found
-    if (candidateIdx != std::numeric_limits<size_t>::max()) {
-        requests[candidateIdx].first.merge(requests[last].first);
-        requests[candidateIdx].second += requests[last].second;
-        requests.pop_back();
-        return true;
-    }
+    void cover(size_t level, size_t offset, Box& box, std::vector<Box>& out) const {
+        const size_t length = lengths_[level];
+        const size_t n      = count(offset, length);
 
-    return false;
-}
+        if (n == 0) {
+            return;
+        }
 
-std::vector<std::pair<mars::MarsRequest, std::size_t>> HyperCube::request(const std::set<std::size_t>& idxs) const {
+        if (n == length) {
+            for (size_t l = level; l < order_.size(); ++l) {
+                auto& values = box[order_[l]];
+                values.resize(dimensions_[order_[l]]);
+                std::iota(values.begin(), values.end(), 0);
+            }
+            out.push_back(box);
+            return;
+        }
 
-    using IndexSet = std::set<std::size_t>;
+        const size_t axis  = order_[level];
+        const size_t slice = lengths_[level + 1];
 
-    ASSERT(idxs.size() > 0);
+        // group the slices along the axis by content
+        std::vector<Slices> groups;
+        std::unordered_map<size_t, std::vector<size_t>> byHash;
 
-    if (idxs.size() <= 1) {
-        return {{requestOf(*idxs.begin()), 1}};
-    }
+        for (eckit::Ordinal v = 0; v < dimensions_[axis]; ++v) {
+            size_t o = offset + v * slice;
+            if (count(o, slice) == 0) {
+                continue;
+            }
 
-    // -- helper lambdas --------------------------------------------
+            auto& candidates = byHash[bits_.hash(o, slice)];
+            auto same        = std::find_if(candidates.begin(), candidates.end(),
+                                            [&](size_t g) { return bits_.equal(groups[g].offset, o, slice); });
+            if (same != candidates.end()) {
+                groups[*same].values.push_back(v);
+            }
+            else {
+                candidates.push_back(groups.size());
+                groups.push_back({{v}, o});
+            }
+        }
 
-    // Partition the cube into a set of slices along the given axis.
-    const auto sliceAlongAxis = [&](const IndexSet& set, std::size_t axis) {
-        std::map<eckit::Ordinal, IndexSet> slices;
-        std::vector<eckit::Ordinal> coords(axes_.size());
+        for (const auto& g : groups) {
+            box[axis] = g.values;
+            cover(level + 1, g.offset, box, out);
+        }
+    }
 
-        for (std::size_t idx : set) {
-            cube_.coordinates(idx, coords);
-            slices[coords[axis]].insert(idx);
+    /// Merges the boxes that only differ along one axis
+    void merge(std::vector<Box>& boxes) const {
+        bool merged = true;
+        while (merged && boxes.size() > 1) {
+            merged = false;
+            for (size_t axis = 0; axis < dimensions_.size(); ++axis) {
+                std::map<Box, size_t> others;
+                std::vector<Box> out;
+                for (auto& b : boxes) {
+                    Box key(b);
+                    key[axis].clear();
+                    auto [j, inserted] = others.emplace(std::move(key), out.size());
+                    if (inserted) {
+                        out.push_back(std::move(b));
+                        continue;
+                    }
+                    auto& values = out[j->second][axis];
+                    std::vector<eckit::Ordinal> u;
+                    u.reserve(values.size() + b[axis].size());
+                    std::merge(values.begin(), values.end(), b[axis].begin(), b[axis].end(), std::back_inserter(u));
+                    values = std::move(u);
+                    merged = true;
+                }
+                boxes = std::move(out);
+            }
         }
+    }
 
-        return slices;
-    };
+    const Bitset& bits_;
+    bool value_;
+    const std::vector<eckit::Ordinal>& dimensions_;
+    const std::vector<eckit::Ordinal>& strides_;
+    std::vector<size_t> order_;     // axes, slowest varying first
+    std::vector<size_t> lengths_;  // lengths_[l]: cells of a sub-cube of the axes order_[l..]
+};
 
-    // Pick the axis which can be partitioned into the smallest number of slices (>1).
-    const auto pickBestAxis = [&](const IndexSet& set) -> std::size_t {
-        std::size_t bestAxis    = 0;
-        std::size_t bestNSlices = std::numeric_limits<std::size_t>::max();
+}  // namespace
 
-        for (std::size_t axis = 0; axis < axes_.size(); ++axis) {
-            const std::size_t nSlices = sliceAlongAxis(set, axis).size();
-            if (nSlices > 1 && nSlices < bestNSlices) {
-                bestAxis    = axis;
-                bestNSlices = nSlices;
-            }
-        }
+std::vector<std::pair<mars::MarsRequest, std::size_t>> HyperCube::request(const std::set<std::size_t>& idxs) const {
+    ASSERT(idxs.size() > 0);
 
-        ASSERT(bestNSlices != std::numeric_limits<std::size_t>::max());
-        return bestAxis;
-    };
+    Bitset bits(size(), false);
+    for (size_t idx : idxs) {
+        bits.set(idx);
+    }
+    return request(bits, true);
+}
 
-    // ---------------------------------------------------------------
+std::vector<std::pair<mars::MarsRequest, std::size_t>> HyperCube::request(const Bitset& bits, bool value) const {
 
-    const std::size_t axis = pickBestAxis(idxs);
-    const auto slices      = sliceAlongAxis(idxs, axis);
+    const std::vector<eckit::Ordinal>& dimensions = cube_.dimensions();
 
-    std::vector<std::pair<mars::MarsRequest, std::size_t>> result;
+    // strides of the axes in the cube's layout
+    std::vector<eckit::Ordinal> strides(dimensions.size());
+    std::vector<eckit::Ordinal> coords(dimensions.size(), 0);
+    for (size_t i = 0; i < dimensions.size(); ++i) {
+        coords[i]  = 1;
+        strides[i] = dimensions[i] > 1 ? cube_.index(coords) : 0;
+        coords[i]  = 0;
+    }
 
-    // Process each slice recursively, appending and merging on the fly.
-    for (const auto& [coord, subIdxs] : slices) {
-        auto subRequests = request(subIdxs);  // recursion
+    std::vector<std::pair<mars::MarsRequest, std::size_t>> result;
 
-        result.insert(result.end(), subRequests.begin(), subRequests.end());
-        while (mergeLast(result)) {}
+    for (const Box& box : Cover(bits, value, dimensions, strides).boxes()) {
+        mars::MarsRequest r(verb_);
+        size_t n = 1;
+        for (size_t i = 0; i < axes_.size(); ++i) {
+            std::vector<std::string> values;
+            values.reserve(box[i].size());
+            for (eckit::Ordinal c : box[i]) {
+                values.push_back(axes_[i]->valueOf(c));
+            }
+            r.values(axes_[i]->name(), values);
+            n *= values.size();
+        }
+        result.emplace_back(std::move(r), n);
     }
 
     return result;
 }
 
-std::vector<metkit::mars::MarsRequest> HyperCube::aggregatedRequests(bool remaining) const {
+std::vector<metkit::mars::MarsRequest> HyperCube::aggregatedRequests(bool remaining, bool compact) const {
+    return aggregatedRequests(set_, remaining, compact);
+}
 
-    if (countVacant() == (remaining ? 0 : size()))
-        return std::vector<metkit::mars::MarsRequest>{};
+std::vector<metkit::mars::MarsRequest> HyperCube::aggregatedRequests(const Bitset& fields, bool remaining,
+                                                                     bool compact) const {
 
-    std::set<size_t> idxs;
-    for (size_t i = 0; i < set_.size(); ++i) {
-        if (set_[i] == remaining)
-            idxs.emplace(i);
-    }
+    if (fields.count() == (remaining ? 0 : fields.size()))
+        return std::vector<metkit::mars::MarsRequest>{};
 
-    std::vector<std::pair<metkit::mars::MarsRequest, size_t>> requests = request(idxs);
+    std::vector<std::pair<metkit::mars::MarsRequest, size_t>> requests = request(fields, remaining);
 
     std::vector<metkit::mars::MarsRequest> out;
-    for (auto req : requests)
-        out.push_back(req.first);
+    out.reserve(requests.size());
+    if (compact) {
+        const auto& language = metkit::mars::MarsLanguage::instance(verb_);
+        for (const auto& req : requests)
+            out.push_back(language.compact(req.first));
+        return out;
+    }
+    for (auto& req : requests)
+        out.push_back(std::move(req.first));
     return out;
 }
 
@@ -311,6 +396,14 @@ metkit::mars::MarsRequest HyperCube::requestOf(size_t index) const {
     return request;
 }
 
+metkit::mars::MarsRequest HyperCube::axesRequest() const {
+    metkit::mars::MarsRequest request(verb_);
+    for (const auto& a : axes_) {
+        request.values(a->name(), a->values());
+    }
+    return request;
+}
+
 size_t HyperCube::count() const {
     return count_;
 }
@@ -318,17 +411,20 @@ size_t HyperCube::countVacant() const {
     return count_;
 }
 
+metkit::mars::MarsRequest HyperCube::vacantField(size_t n) const {
+    if (n >= countVacant()) {
+        std::ostringstream oss;
+        oss << "HyperCube::vacantField no vacant field " << n << ", " << countVacant() << " vacant";
+        throw eckit::UserError(oss.str());
+    }
+    return requestOf(set_.select(n));
+}
+
 size_t HyperCube::fieldOrdinal(const metkit::mars::MarsRequest& r, bool noholes) const {
     int idx = indexOf(r);
     ASSERT(idx >= 0);
     if (noholes) {
-        size_t p = 0;
-        for (size_t i = 0; i < idx; ++i) {
-            if (set_[i]) {
-                p++;
-            }
-        }
-        return p;
+        return set_.rank(idx);
     }
     return idx;
 }
@@ -20,9 +20,11 @@
 #include <memory>
 #include <vector>
 
+#include "eckit/filesystem/PathName.h"
 #include "eckit/utils/HyperCube.h"
 
 #include "metkit/config/LibMetkit.h"
+#include "metkit/hypercube/Bitset.h"
 #include "metkit/mars/MarsRequest.h"
 
 
@@ -30,6 +32,7 @@ namespace metkit {
 namespace hypercube {
 
 class Axis;
+class HyperCubeFile;
 
 class AxisOrder {
 public:  // methods
@@ -55,8 +58,13 @@ class HyperCube {
 public:
 
     HyperCube(const metkit::mars::MarsRequest&);
+    /// Reopens a cube saved with save()
+    explicit HyperCube(const HyperCubeFile&);
     ~HyperCube();
 
+    /// Saves the axes and the fields of the cube, see HyperCubeFile
+    void save(const eckit::PathName&) const;
+
     bool contains(const metkit::mars::MarsRequest&) const;
     bool clear(const metkit::mars::MarsRequest&);
 
@@ -65,33 +73,60 @@ public:
     size_t size() const { return cube_.count(); }
 
     size_t fieldOrdinal(const metkit::mars::MarsRequest&, bool noholes = true) const;
-    std::vector<metkit::mars::MarsRequest> vacantRequests() const { return aggregatedRequests(true); }
-    std::vector<metkit::mars::MarsRequest> requests() const { return aggregatedRequests(false); }
+
+    /// The n-th vacant field, in the order of the cube
+    metkit::mars::MarsRequest vacantField(size_t n) const;
+
+    /// Requests covering the vacant fields (resp. the cleared ones). When compact, runs of evenly spaced values are
+    /// written as from/to/by lists, see MarsLanguage::compact()
+    std::vector<metkit::mars::MarsRequest> vacantRequests(bool compact = false) const {
+        return aggregatedRequests(true, compact);
+    }
+    std::vector<metkit::mars::MarsRequest> requests(bool compact = false) const {
+        return aggregatedRequests(false, compact);
+    }
 
 protected:
 
-    std::vector<metkit::mars::MarsRequest> aggregatedRequests(bool remaining) const;
+    /// Tag for cubes that keep track of their fields themselves, e.g. ConcurrentHyperCube
+    struct AxesOnly {};
+
+    /// Builds the axes of the cube, without the bitset of its fields
+    HyperCube(const metkit::mars::MarsRequest&, AxesOnly);
+
+    std::vector<metkit::mars::MarsRequest> aggregatedRequests(bool remaining, bool compact = false) const;
+    /// As above, for the given fields instead of the fields of the cube
+    std::vector<metkit::mars::MarsRequest> aggregatedRequests(const Bitset& fields, bool remaining,
+                                                              bool compact = false) const;
     int indexOf(const metkit::mars::MarsRequest&) const;
     bool clear(int index);
     metkit::mars::MarsRequest requestOf(size_t index) const;
 
+    /// The verb and the axes of the cube, with the axes in the order of the cube
+    metkit::mars::MarsRequest axesRequest() const;
+
     // Given a set of indices, build the *minimal* collection of Mars requests that cover them.
     // Each entry in the result vector is: { merged_request, number_of_points_covered_by_that_request }
     /// @note: This does not take into account whether the point is "set" or not
     std::vector<std::pair<metkit::mars::MarsRequest, size_t>> request(const std::set<size_t>& idxs) const;
 
+    /// As above, for the indices i with bits[i] == value
+    std::vector<std::pair<metkit::mars::MarsRequest, size_t>> request(const Bitset& bits, bool value) const;
+
 private:
 
     std::string verb_;
     std::vector<Axis*> axes_;
     std::map<std::string, Axis*> axesByName_;
-    std::vector<bool> set_;
+    Bitset set_;
     eckit::HyperCube cube_;
     size_t count_;
 
 
     void print(std::ostream&) const;
 
+    friend class HyperCubeFile;
+
     friend std::ostream& operator<<(std::ostream& s, const HyperCube& p) {
         p.print(s);
         return s;
@@ -0,0 +1,388 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   HyperCubeFile.cc
+/// @date   Oct 2026
+
+#include "metkit/hypercube/HyperCubeFile.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FileHandle.h"
+
+#include "metkit/utils/MappedFile.h"
+
+namespace metkit::hypercube {
+
+namespace {
+
+constexpr char magic[8] = "MKCUBE";
+
+/// Bump when the layout below changes
+constexpr uint32_t formatVersion = 1;
+
+constexpr size_t blockBits = 512;  // cells per entry of the ranks of sparse payloads
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t layout;
+    uint64_t size;           // cells
+    uint64_t vacant;         // fields still in the cube
+    uint64_t payloadSize;    // bytes per payload
+    uint64_t countPayloads;  // cells holding a payload
+    uint64_t axesLength;     // bytes of the encoded axes
+    uint64_t reserved;
+};
+
+static_assert(sizeof(Header) == 64);
+
+size_t align(size_t offset) {
+    return (offset + 63) & ~size_t(63);
+}
+
+size_t words(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+/// Offsets of the sections of a file
+struct Sections {
+    explicit Sections(const Header& h) {
+        auto layout     = HyperCubeFile::Layout(h.layout);
+        size_t bitBytes = words(h.size) * sizeof(uint64_t);
+
+        axes     = sizeof(Header);
+        fields   = align(axes + h.axesLength);
+        payloads = align(fields + bitBytes);
+        ranks    = layout == HyperCubeFile::Layout::None ? payloads : align(payloads + bitBytes);
+        data = layout == HyperCubeFile::Layout::Sparse ? align(ranks + (h.size + blockBits - 1) / blockBits * 8) : ranks;
+        end  = data + h.payloadSize * (layout == HyperCubeFile::Layout::Dense ? h.size : h.countPayloads);
+    }
+
+    size_t axes;
+    size_t fields;
+    size_t payloads;
+    size_t ranks;
+    size_t data;
+    size_t end;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void encode(std::string& out, uint32_t n) {
+    out.append(reinterpret_cast<const char*>(&n), sizeof(n));
+}
+
+void encode(std::string& out, const std::string& s) {
+    encode(out, static_cast<uint32_t>(s.size()));
+    out.append(s);
+}
+
+std::string encode(const metkit::mars::MarsRequest& axes) {
+    std::string out;
+    encode(out, axes.verb());
+    std::vector<std::string> names = axes.params();
+    encode(out, static_cast<uint32_t>(names.size()));
+    for (const auto& name : names) {
+        encode(out, name);
+        const auto& values = axes.values(name);
+        encode(out, static_cast<uint32_t>(values.size()));
+        for (const auto& v : values) {
+            encode(out, v);
+        }
+    }
+    return out;
+}
+
+class Decoder {
+public:
+
+    Decoder(const eckit::PathName& path, const char* begin, size_t length) :
+        path_(path), pos_(begin), end_(begin + length) {}
+
+    uint32_t number() {
+        uint32_t n;
+        std::memcpy(&n, take(sizeof(n)), sizeof(n));
+        return n;
+    }
+
+    std::string string() {
+        uint32_t n = number();
+        return std::string(take(n), n);
+    }
+
+private:
+
+    const char* take(size_t n) {
+        if (size_t(end_ - pos_) < n) {
+            throw eckit::BadValue("HyperCubeFile: truncated axes in " + path_.asString());
+        }
+        const char* p = pos_;
+        pos_ += n;
+        return p;
+    }
+
+    const eckit::PathName& path_;
+    const char* pos_;
+    const char* end_;
+};
+
+const Header& header(const MappedFile& file) {
+    const auto* h = static_cast<const Header*>(file.data());
+    if (file.size() < sizeof(Header) || std::memcmp(h->magic, magic, sizeof(magic)) != 0) {
+        throw eckit::BadValue("HyperCubeFile: " + file.path().asString() + " is not a hypercube file");
+    }
+    if (h->version != formatVersion) {
+        std::ostringstream oss;
+        oss << "HyperCubeFile: " << file.path() << " has format version " << h->version << ", expected "
+            << formatVersion;
+        throw eckit::BadValue(oss.str());
+    }
+    if (h->layout > uint32_t(HyperCubeFile::Layout::Sparse)) {
+        std::ostringstream oss;
+        oss << "HyperCubeFile: " << file.path() << " has unknown payload layout " << h->layout;
+        throw eckit::BadValue(oss.str());
+    }
+    if (file.size() < Sections(*h).end) {
+        throw eckit::BadValue("HyperCubeFile: " + file.path().asString() + " is truncated");
+    }
+    return *h;
+}
+
+metkit::mars::MarsRequest decode(const MappedFile& file, const Header& h) {
+    Decoder d(file.path(), static_cast<const char*>(file.data()) + Sections(h).axes, h.axesLength);
+
+    metkit::mars::MarsRequest axes(d.string());
+    for (uint32_t n = d.number(); n > 0; --n) {
+        std::string name = d.string();
+        std::vector<std::string> values(d.number());
+        for (auto& v : values) {
+            v = d.string();
+        }
+        axes.values(name, values);
+    }
+    return axes;
+}
+
+bool test(const uint64_t* words, size_t i) {
+    return (words[i / 64] >> (i % 64)) & 1;
+}
+
+/// Writes the sections of a file one after the other, padding each to its offset
+class Writer {
+public:
+
+    explicit Writer(const eckit::PathName& path) : handle_(path) { handle_.openForWrite(0); }
+
+    void write(size_t offset, const void* data, size_t length) {
+        ASSERT(offset >= pos_);
+        static const char zeros[64] = {};
+        while (pos_ < offset) {
+            put(zeros, std::min(offset - pos_, sizeof(zeros)));
+        }
+        put(data, length);
+    }
+
+    /// Pads the file to its end, the last section may be empty
+    void close(size_t end) {
+        write(end, nullptr, 0);
+        handle_.close();
+    }
+
+private:
+
+    void put(const void* data, size_t length) {
+        if (length > 0) {
+            long written = handle_.write(data, length);
+            ASSERT(written == long(length));
+            pos_ += length;
+        }
+    }
+
+    eckit::FileHandle handle_;
+    size_t pos_ = 0;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct HyperCubeFile::Opened {
+    std::unique_ptr<MappedFile> file;
+    const Header* header;
+    metkit::mars::MarsRequest axes;
+};
+
+HyperCubeFile::Opened HyperCubeFile::open(const eckit::PathName& path) {
+    auto file       = std::make_unique<MappedFile>(path);
+    const Header& h = header(*file);
+    auto axes       = decode(*file, h);
+    return Opened{std::move(file), &h, std::move(axes)};
+}
+
+HyperCubeFile::HyperCubeFile(const eckit::PathName& path) : HyperCubeFile(open(path)) {}
+
+HyperCubeFile::HyperCubeFile(Opened&& opened) :
+    HyperCube(opened.axes, AxesOnly{}), file_(std::move(opened.file)), axes_(std::move(opened.axes)) {
+
+    const Header& h = *opened.header;
+
+    // the axes are laid out in the order of axis.yaml, which must not have changed since the file was written
+    if (size() != h.size || axesRequest().params() != axes_.params()) {
+        throw eckit::BadValue("HyperCubeFile: the axes of " + file_->path().asString() +
+                              " are not in the current axis order");
+    }
+
+    Sections sections(h);
+    const char* base = static_cast<const char*>(file_->data());
+
+    countVacant_   = h.vacant;
+    layout_        = Layout(h.layout);
+    payloadSize_   = h.payloadSize;
+    countPayloads_ = h.countPayloads;
+
+    fields_ = reinterpret_cast<const uint64_t*>(base + sections.fields);
+    if (layout_ != Layout::None) {
+        payloads_ = reinterpret_cast<const uint64_t*>(base + sections.payloads);
+        data_     = base + sections.data;
+    }
+    if (layout_ == Layout::Sparse) {
+        ranks_ = reinterpret_cast<const uint64_t*>(base + sections.ranks);
+    }
+}
+
+HyperCubeFile::~HyperCubeFile() = default;
+
+void HyperCubeFile::write(const eckit::PathName& path, const HyperCube& cube, Layout layout, size_t payloadSize,
+                          const Bitset* payloads, const void* data) {
+
+    ASSERT((layout == Layout::None) == (payloadSize == 0));
+    ASSERT(layout == Layout::None || (payloads && payloads->size() == cube.size()));
+    ASSERT(layout == Layout::None || payloads->count() == 0 || data);
+
+    std::string axes = encode(cube.axesRequest());
+
+    Header h{};
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version       = formatVersion;
+    h.layout        = uint32_t(layout);
+    h.size          = cube.size();
+    h.vacant        = cube.set_.count();
+    h.payloadSize   = payloadSize;
+    h.countPayloads = layout == Layout::None ? 0 : payloads->count();
+    h.axesLength    = axes.size();
+
+    Sections sections(h);
+
+    // write to a temporary file then rename, so that readers never map a partial cube
+    std::ostringstream tmp;
+    tmp << path << ".tmp." << ::getpid();
+    eckit::PathName tmpPath(tmp.str());
+
+    Writer w(tmpPath);
+    w.write(0, &h, sizeof(h));
+    w.write(sections.axes, axes.data(), axes.size());
+    w.write(sections.fields, cube.set_.words().data(), cube.set_.words().size() * sizeof(uint64_t));
+
+    if (layout != Layout::None) {
+        w.write(sections.payloads, payloads->words().data(), payloads->words().size() * sizeof(uint64_t));
+    }
+
+    if (layout == Layout::Sparse) {
+        std::vector<uint64_t> ranks((h.size + blockBits - 1) / blockBits);
+        for (size_t b = 1; b < ranks.size(); ++b) {
+            ranks[b] = payloads->rank(b * blockBits);
+        }
+        w.write(sections.ranks, ranks.data(), ranks.size() * sizeof(uint64_t));
+        w.write(sections.data, data, h.countPayloads * payloadSize);
+    }
+
+    if (layout == Layout::Dense) {
+        // expand the packed payloads a chunk of cells at a time, leaving zeros in the cells without one
+        const size_t chunk = 65536;
+        const char* next   = static_cast<const char*>(data);
+        std::vector<char> buffer;
+        for (size_t begin = 0; begin < h.size; begin += chunk) {
+            size_t end = std::min<size_t>(begin + chunk, h.size);
+            buffer.assign((end - begin) * payloadSize, 0);
+            for (size_t i = begin; i < end; ++i) {
+                if (payloads->test(i)) {
+                    std::memcpy(buffer.data() + (i - begin) * payloadSize, next, payloadSize);
+                    next += payloadSize;
+                }
+            }
+            w.write(sections.data + begin * payloadSize, buffer.data(), buffer.size());
+        }
+    }
+
+    w.close(sections.end);
+    eckit::PathName::rename(tmpPath, path);
+}
+
+bool HyperCubeFile::contains(const metkit::mars::MarsRequest& r) const {
+    int idx = indexOf(r);
+    return idx >= 0 && test(fields_, idx);
+}
+
+Bitset HyperCubeFile::fields() const {
+    return Bitset(size(), std::vector<uint64_t>(fields_, fields_ + words(size())));
+}
+
+const void* HyperCubeFile::payload(size_t idx) const {
+    ASSERT(idx < size());
+
+    if (!payloads_ || !test(payloads_, idx)) {
+        return nullptr;
+    }
+
+    size_t n = idx;
+    if (layout_ == Layout::Sparse) {
+        size_t block = idx / blockBits;
+        n            = ranks_[block];
+        for (size_t w = block * (blockBits / 64); w < idx / 64; ++w) {
+            n += __builtin_popcountll(payloads_[w]);
+        }
+        if (idx % 64) {
+            n += __builtin_popcountll(payloads_[idx / 64] & ((uint64_t(1) << (idx % 64)) - 1));
+        }
+    }
+    return data_ + n * payloadSize_;
+}
+
+void HyperCubeFile::forEachPayload(const std::function<void(size_t, const void*)>& f) const {
+    if (!payloads_) {
+        return;
+    }
+    size_t n = 0;
+    for (size_t w = 0; w < words(size()); ++w) {
+        for (uint64_t word = payloads_[w]; word; word &= word - 1) {
+            size_t idx = w * 64 + __builtin_ctzll(word);
+            f(idx, data_ + (layout_ == Layout::Sparse ? n++ : idx) * payloadSize_);
+        }
+    }
+}
+
+void HyperCubeFile::checkPayloadSize(size_t size) const {
+    if (layout_ == Layout::None || size != payloadSize_) {
+        std::ostringstream oss;
+        oss << "HyperCubeFile: " << file_->path() << " holds payloads of " << payloadSize_ << " bytes, not " << size;
+        throw eckit::BadValue(oss.str());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::hypercube
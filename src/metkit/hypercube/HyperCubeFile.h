@@ -0,0 +1,134 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   HyperCubeFile.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+
+#include "metkit/hypercube/Bitset.h"
+#include "metkit/hypercube/HyperCube.h"
+
+namespace metkit {
+class MappedFile;
+}
+
+namespace metkit::hypercube {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief A HyperCube saved to disk, memory mapped and read-only
+///
+/// The file holds, each section aligned on 64 bytes:
+///   - a header with the number of cells, fields and payloads
+///   - the verb and the axes of the cube, in the order of the cube
+///   - the fields, one bit per cell in 64-bit words
+///   - when the cube has payloads, one bit per cell holding a payload, then the payloads, all of the same size.
+///     Dense payloads are stored for every cell. Sparse payloads are stored for the cells holding one only, and are
+///     found through the number of payloads before each block of 512 cells, which the file also holds.
+///
+/// Opening a file maps it and decodes the axes only, so cubes of any size are reopened at once, and processes opening
+/// the same file share its pages. Numbers and payloads are in the byte order of the machine that wrote the file.
+///
+/// A file is reopened as a HyperCube (or HyperCubePayloaded) to carry on clearing its fields.
+class HyperCubeFile : private HyperCube {
+public:  // types
+
+    enum class Layout : uint32_t
+    {
+        None   = 0,  // no payloads
+        Dense  = 1,
+        Sparse = 2,
+    };
+
+public:  // methods
+
+    explicit HyperCubeFile(const eckit::PathName&);
+    ~HyperCubeFile();
+
+    /// Saves a cube. With a layout other than None, payloads holds the cells holding a payload and data their
+    /// payloads of payloadSize bytes, packed in increasing order of cell
+    static void write(const eckit::PathName&, const HyperCube&, Layout = Layout::None, size_t payloadSize = 0,
+                      const Bitset* payloads = nullptr, const void* data = nullptr);
+
+    /// The verb and the axes of the cube
+    const metkit::mars::MarsRequest& axes() const { return axes_; }
+
+    using HyperCube::size;
+    size_t countVacant() const { return countVacant_; }
+
+    bool contains(const metkit::mars::MarsRequest&) const;
+
+    /// Copy of the fields, one bit per cell
+    Bitset fields() const;
+
+    std::vector<metkit::mars::MarsRequest> vacantRequests(bool compact = false) const {
+        return aggregatedRequests(fields(), true, compact);
+    }
+    std::vector<metkit::mars::MarsRequest> requests(bool compact = false) const {
+        return aggregatedRequests(fields(), false, compact);
+    }
+
+    Layout layout() const { return layout_; }
+    size_t payloadSize() const { return payloadSize_; }
+    size_t countPayloads() const { return countPayloads_; }
+
+    /// The payload of a cell, nullptr if it holds none
+    const void* payload(size_t idx) const;
+
+    template <typename T>
+    const T* payload(const metkit::mars::MarsRequest& r) const {
+        checkPayloadSize(sizeof(T));
+        int idx = indexOf(r);
+        return idx < 0 ? nullptr : static_cast<const T*>(payload(idx));
+    }
+
+    /// Calls f(idx, payload) for each cell holding a payload, in increasing order of cell
+    void forEachPayload(const std::function<void(size_t, const void*)>& f) const;
+
+private:  // types
+
+    struct Opened;
+
+private:  // methods
+
+    explicit HyperCubeFile(Opened&&);
+
+    /// Maps a file, checks its header and decodes its axes, once for the cube and its axes
+    static Opened open(const eckit::PathName&);
+
+    void checkPayloadSize(size_t) const;
+
+private:  // members
+
+    std::unique_ptr<MappedFile> file_;
+    metkit::mars::MarsRequest axes_;
+
+    size_t countVacant_   = 0;
+    Layout layout_        = Layout::None;
+    size_t payloadSize_   = 0;
+    size_t countPayloads_ = 0;
+
+    const uint64_t* fields_   = nullptr;
+    const uint64_t* payloads_ = nullptr;  // cells holding a payload
+    const uint64_t* ranks_    = nullptr;  // number of payloads before each block of 512 cells, for sparse payloads
+    const char* data_         = nullptr;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::hypercube
@@ -15,7 +15,15 @@
 #ifndef metkit_HyperCubePayloaded_H
 #define metkit_HyperCubePayloaded_H
 
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+
 #include "metkit/hypercube/HyperCube.h"
+#include "metkit/hypercube/HyperCubeFile.h"
 
 
 namespace metkit {
@@ -39,6 +47,45 @@ public:
         // throw error for default dedup
     }
 
+    /// Reopens a cube saved with save()
+    HyperCubePayloaded(const HyperCubeFile& file, const Deduplicator<T>& deduplicator) :
+        HyperCube(file), dedup_(deduplicator) {
+        static_assert(std::is_trivially_copyable_v<T>, "only payloads of fixed size can be saved");
+
+        if (file.countPayloads() > 0 && file.payloadSize() != sizeof(T)) {
+            std::ostringstream oss;
+            oss << "HyperCubePayloaded: payloads of " << file.payloadSize() << " bytes, expected " << sizeof(T);
+            throw eckit::BadValue(oss.str());
+        }
+
+        file.forEachPayload([this](size_t idx, const void* data) {
+            T payload;
+            std::memcpy(&payload, data, sizeof(T));
+            entries_.emplace_hint(entries_.end(), idx, payload);
+        });
+    }
+
+    /// Saves the cube with its payloads, densely if they fill more than half of the cube. Payloads are saved byte for
+    /// byte, so T should have no padding
+    void save(const eckit::PathName& path) const {
+        save(path, 2 * entries_.size() > size() ? HyperCubeFile::Layout::Dense : HyperCubeFile::Layout::Sparse);
+    }
+
+    void save(const eckit::PathName& path, HyperCubeFile::Layout layout) const {
+        static_assert(std::is_trivially_copyable_v<T>, "only payloads of fixed size can be saved");
+        ASSERT(layout != HyperCubeFile::Layout::None);
+
+        Bitset cells(size(), false);
+        std::vector<T> payloads;
+        payloads.reserve(entries_.size());
+        for (const auto& [idx, payload] : entries_) {
+            cells.set(idx);
+            payloads.push_back(payload);
+        }
+
+        HyperCubeFile::write(path, *this, layout, sizeof(T), &cells, payloads.data());
+    }
+
 
     void add(const metkit::mars::MarsRequest& request, T payload) {
 
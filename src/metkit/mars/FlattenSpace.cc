@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   FlattenSpace.cc
+/// @date   Oct 2026
+
+#include "metkit/mars/FlattenSpace.h"
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "metkit/mars/MarsLanguage.h"
+#include "metkit/mars/Type.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+FlattenSpace::FlattenSpace(const MarsRequest& request) :
+    FlattenSpace(MarsLanguage::instance(request.verb()), request) {}
+
+FlattenSpace::FlattenSpace(const MarsLanguage& language, const MarsRequest& request) : request_(request), size_(1) {
+
+    const MarsRequest::Parameters& params = request_.parameters();
+    for (size_t i = 0; i < params.size(); ++i) {
+        const Type* t = language.type(params[i].name());
+        if (t->flatten()) {
+            axes_.push_back(Axis{i, params[i].name(), t->flattenValues(request_), 0});
+        }
+    }
+
+    for (auto a = axes_.rbegin(); a != axes_.rend(); ++a) {
+        a->stride = size_;
+        size_ *= a->values.size();
+    }
+}
+
+FlattenSpace::iterator FlattenSpace::at(size_t ordinal) const {
+    ASSERT(ordinal <= size_);
+    return iterator(*this, ordinal);
+}
+
+std::pair<FlattenSpace::iterator, FlattenSpace::iterator> FlattenSpace::partition(size_t i, size_t n) const {
+    ASSERT(i < n);
+
+    size_t q     = size_ / n;
+    size_t r     = size_ % n;
+    size_t first = i * q + std::min(i, r);
+    size_t last  = first + q + (i < r ? 1 : 0);
+
+    return {at(first), at(last)};
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+FlattenSpace::iterator::iterator(const FlattenSpace& space, size_t ordinal) : space_(&space), ordinal_(ordinal) {
+    if (ordinal_ == space_->size_) {
+        return;  // end
+    }
+
+    request_ = space_->request_;
+    digits_.resize(space_->axes_.size());
+    for (size_t a = 0; a < digits_.size(); ++a) {
+        const Axis& axis = space_->axes_[a];
+        digits_[a]       = (ordinal_ / axis.stride) % axis.values.size();
+        set(a);
+    }
+}
+
+void FlattenSpace::iterator::set(size_t a) {
+    const Axis& axis = space_->axes_[a];
+    request_.parameters()[axis.parameter].values(std::vector<std::string>{axis.values[digits_[a]]});
+}
+
+FlattenSpace::iterator& FlattenSpace::iterator::operator++() {
+    ASSERT(space_ && ordinal_ < space_->size_);
+
+    if (++ordinal_ == space_->size_) {
+        request_ = MarsRequest();
+        digits_.clear();
+        return *this;
+    }
+
+    // odometer: the last axis varies fastest, carry to the previous ones
+    for (size_t a = digits_.size(); a-- > 0;) {
+        if (++digits_[a] < space_->axes_[a].values.size()) {
+            set(a);
+            break;
+        }
+        digits_[a] = 0;
+        set(a);
+    }
+
+    return *this;
+}
+
+FlattenSpace::iterator FlattenSpace::iterator::operator++(int) {
+    iterator old(*this);
+    ++(*this);
+    return old;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -0,0 +1,114 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   FlattenSpace.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "metkit/mars/MarsRequest.h"
+
+namespace metkit::mars {
+
+class MarsLanguage;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief The fields of a request, i.e. the cartesian product of the values of its flattened keywords
+///
+/// Fields are numbered by their ordinal, in the order of MarsLanguage::flatten(): the keywords are taken in the order
+/// of the request, the last one varying fastest. The space can be iterated from any ordinal, or split into disjoint
+/// contiguous partitions that are iterated independently, e.g. by different threads.
+class FlattenSpace {
+public:  // types
+
+    /// Forward iterator over the fields. Each step only updates the keywords whose value changes
+    class iterator {
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = MarsRequest;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const MarsRequest*;
+        using reference         = const MarsRequest&;
+
+        iterator() = default;
+
+        reference operator*() const { return request_; }
+        pointer operator->() const { return &request_; }
+
+        iterator& operator++();
+        iterator operator++(int);
+
+        size_t ordinal() const { return ordinal_; }
+
+        bool operator==(const iterator& other) const { return ordinal_ == other.ordinal_; }
+        bool operator!=(const iterator& other) const { return ordinal_ != other.ordinal_; }
+
+    private:
+
+        friend class FlattenSpace;
+
+        iterator(const FlattenSpace& space, size_t ordinal);
+
+        void set(size_t axis);
+
+        const FlattenSpace* space_ = nullptr;
+        size_t ordinal_            = 0;
+        std::vector<size_t> digits_;  // index of the current value of each axis
+        MarsRequest request_;
+    };
+
+public:  // methods
+
+    /// Flattens the request with the types of the language of its verb
+    explicit FlattenSpace(const MarsRequest& request);
+    FlattenSpace(const MarsLanguage& language, const MarsRequest& request);
+
+    /// Number of fields
+    size_t size() const { return size_; }
+
+    iterator begin() const { return at(0); }
+    iterator end() const { return at(size_); }
+
+    /// Iterator positioned on the field of the given ordinal
+    iterator at(size_t ordinal) const;
+
+    /// The field of the given ordinal
+    MarsRequest operator[](size_t ordinal) const { return *at(ordinal); }
+
+    /// The i-th of n disjoint contiguous partitions, of sizes differing by at most one field
+    std::pair<iterator, iterator> partition(size_t i, size_t n) const;
+
+private:  // types
+
+    struct Axis {
+        size_t parameter;  // index in the parameters of the request
+        std::string name;
+        std::vector<std::string> values;
+        size_t stride;  // number of fields between two values of this axis
+    };
+
+private:  // members
+
+    MarsRequest request_;
+    std::vector<Axis> axes_;
+    size_t size_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
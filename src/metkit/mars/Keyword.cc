@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "metkit/mars/Keyword.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Open addressing hash table, of which slots are only ever filled (under the mutex), so that readers need no lock.
+/// Keywords come from the language, the number of distinct ones is small. Should the table become half full, further
+/// keywords go to a map guarded by the mutex.
+class KeywordTable {
+
+    static constexpr size_t capacity = 8192;
+    static constexpr size_t mask     = capacity - 1;
+
+    struct Entry {
+        std::string name;
+        uint32_t id;
+    };
+
+    std::array<std::atomic<const Entry*>, capacity> slots_{};
+    std::deque<Entry> entries_;  // by id, stable addresses
+    std::unordered_map<std::string, uint32_t> overflow_;
+    std::atomic<bool> overflowed_{false};
+    size_t size_ = 0;  // entries in slots_
+    std::mutex mutex_;
+
+    uint32_t lookup(const std::string& name, size_t hash) const {
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Entry* e = slots_[i].load(std::memory_order_acquire);
+            if (e == nullptr) {
+                return Keyword::none;
+            }
+            if (e->name == name) {
+                return e->id;
+            }
+        }
+    }
+
+public:
+
+    uint32_t find(const std::string& name) {
+        uint32_t id = lookup(name, std::hash<std::string>{}(name));
+        if (id == Keyword::none && overflowed_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto j = overflow_.find(name);
+            if (j != overflow_.end()) {
+                id = j->second;
+            }
+        }
+        return id;
+    }
+
+    uint32_t insert(const std::string& name) {
+        const size_t hash = std::hash<std::string>{}(name);
+        if (uint32_t id = lookup(name, hash); id != Keyword::none) {
+            return id;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (uint32_t id = lookup(name, hash); id != Keyword::none) {
+            return id;
+        }
+        if (auto j = overflow_.find(name); j != overflow_.end()) {
+            return j->second;
+        }
+
+        ASSERT(entries_.size() < Keyword::none);
+        const uint32_t id = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(Entry{name, id});
+
+        if (size_ >= capacity / 2) {
+            overflow_.emplace(name, id);
+            overflowed_.store(true, std::memory_order_release);
+            return id;
+        }
+
+        size_t i = hash & mask;
+        while (slots_[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & mask;
+        }
+        slots_[i].store(&entries_.back(), std::memory_order_release);
+        ++size_;
+        return id;
+    }
+
+    const std::string& name(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(id < entries_.size());
+        return entries_[id].name;
+    }
+};
+
+KeywordTable& table() {
+    static KeywordTable* table = new KeywordTable();  // never deleted, keywords are used during static destruction
+    return *table;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t Keyword::id(const std::string& name) {
+    return table().insert(name);
+}
+
+uint32_t Keyword::find(const std::string& name) {
+    return table().find(name);
+}
+
+const std::string& Keyword::name(uint32_t id) {
+    return table().name(id);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -0,0 +1,44 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   Keyword.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Process-wide table of interned keywords
+///
+/// Each keyword (class, stream, param, ...) is given a small integer id, used by MarsRequest to look up its parameters
+/// and by the language contexts (see ContextRule::keyId). Ids are stable for the lifetime of the process. Looking up a
+/// keyword does not take any lock, only interning a new one does.
+class Keyword {
+public:  // methods
+
+    static constexpr uint32_t none = UINT32_MAX;
+
+    /// Id of the keyword, interning it if needed
+    static uint32_t id(const std::string& name);
+
+    /// Id of the keyword, or none if it has never been interned
+    static uint32_t find(const std::string& name);
+
+    static const std::string& name(uint32_t id);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
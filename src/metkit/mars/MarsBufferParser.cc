@@ -0,0 +1,265 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MarsBufferParser.cc
+/// @date   Oct 2026
+
+#include "metkit/mars/MarsBufferParser.h"
+
+#include <array>
+#include <cctype>
+#include <cstring>
+
+#include "eckit/parser/StreamParser.h"
+
+namespace metkit::mars {
+
+namespace {
+
+/// Character classes, so that tokens are scanned with a single table lookup per character
+enum : unsigned char {
+    IDENT  = 1,  // may appear in a keyword, verb or unquoted value (see MarsParser)
+    SPACE  = 2,
+    STRING = 4,  // ends a run of plain characters in a quoted string: quotes, backslash and comments
+};
+
+struct CharTable {
+    std::array<unsigned char, 256> classes{};
+
+    CharTable() {
+        for (int c = 0; c < 256; ++c) {
+            if (std::isalnum(c) || c == '_' || c == ':' || c == '-' || c == '.' || c == '@') {
+                classes[c] |= IDENT;
+            }
+            if (std::isspace(c)) {
+                classes[c] |= SPACE;
+            }
+        }
+        for (unsigned char c : {'"', '\'', '\\', '#'}) {
+            classes[c] |= STRING;
+        }
+    }
+
+    bool is(char c, unsigned char cls) const { return classes[static_cast<unsigned char>(c)] & cls; }
+};
+
+const CharTable table;
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MarsBufferParser::MarsBufferParser(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+MarsBufferParser::MarsBufferParser(std::string_view buffer) : MarsBufferParser(buffer.data(), buffer.size()) {}
+
+char MarsBufferParser::peek(bool spaces) {
+    while (pos_ != end_) {
+        char c = *pos_;
+
+        if (c == '#') {  // comment, up to the end of the line
+            const void* eol = std::memchr(pos_, '\n', end_ - pos_);
+            pos_            = eol ? static_cast<const char*>(eol) : end_;
+            continue;
+        }
+
+        if (spaces || !table.is(c, SPACE)) {
+            return c;
+        }
+
+        if (c == '\n') {
+            line_++;
+        }
+        ++pos_;
+    }
+    return 0;
+}
+
+char MarsBufferParser::next(bool spaces) {
+    char c = peek(spaces);
+    if (pos_ == end_) {
+        throw eckit::StreamParser::Error("MarsBufferParser: unexpected end of input", line_ + 1);
+    }
+    ++pos_;
+    return c;
+}
+
+void MarsBufferParser::consume(char c) {
+    char n = next();
+    if (n != c) {
+        throw eckit::StreamParser::Error(std::string("MarsBufferParser: expected '") + c + "', got '" + n + "'",
+                                         line_ + 1);
+    }
+}
+
+std::string MarsBufferParser::parseString(char quote) {
+    consume(quote);
+    std::string s;
+    for (;;) {
+        // copy the run of plain characters in one go
+        const char* start = pos_;
+        while (pos_ != end_ && !table.is(*pos_, STRING)) {
+            ++pos_;
+        }
+        s.append(start, pos_);
+
+        char c = next(true);
+        if (c == '\\') {
+            c = next(true);
+            switch (c) {
+                case '"':
+                case '\'':
+                case '\\':
+                case '/':
+                    s += c;
+                    break;
+
+                case 'b':
+                    s += '\b';
+                    break;
+
+                case 'f':
+                    s += '\f';
+                    break;
+
+                case 'n':
+                    s += '\n';
+                    break;
+
+                case 'r':
+                    s += '\r';
+                    break;
+
+                case 't':
+                    s += '\t';
+                    break;
+
+                case 'u':
+                    throw eckit::StreamParser::Error(
+                        std::string("JSONTokenizer::parseString \\uXXXX format not supported"));
+
+                default:
+                    throw eckit::StreamParser::Error(std::string("JSONTokenizer::parseString invalid \\ char '") + c +
+                                                     "'");
+            }
+        }
+        else {
+            if (c == quote) {
+                return s;
+            }
+            s += c;
+        }
+    }
+}
+
+std::string_view MarsBufferParser::parseIndent() {
+    peek();
+    const char* start = pos_;
+    while (pos_ != end_ && table.is(*pos_, IDENT)) {
+        ++pos_;
+    }
+    return {start, static_cast<size_t>(pos_ - start)};
+}
+
+std::string MarsBufferParser::parseIndents() {
+    std::string_view first = parseIndent();
+    std::string s;
+
+    for (;;) {
+        char c = peek(true);
+        while (c == ' ') {
+            next(true);
+            c = peek(true);
+        }
+
+        if (!table.is(c, IDENT)) {
+            break;
+        }
+
+        if (s.empty()) {
+            s = first;
+        }
+        s += ' ';
+        s += parseIndent();
+    }
+
+    return s.empty() ? std::string(first) : s;
+}
+
+std::string MarsBufferParser::parseValue() {
+    char c = peek();
+
+    if (c == '\"' || c == '\'') {
+        return parseString(c);
+    }
+
+    return parseIndents();
+}
+
+std::vector<std::string> MarsBufferParser::parseValues() {
+    std::vector<std::string> v(1, parseValue());
+    char c = peek();
+    while (c == '/') {
+        consume('/');
+        v.push_back(parseValue());
+        c = peek();
+    }
+    return v;
+}
+
+std::string_view MarsBufferParser::parseVerb() {
+    char c = peek();
+    if (!std::isalpha(static_cast<unsigned char>(c)) && c != '_') {
+        throw eckit::StreamParser::Error(std::string("MarsParser::parseVerb invalid char '") + c + "'", line_ + 1);
+    }
+    return parseIndent();
+}
+
+MarsParsedRequest MarsBufferParser::parseRequest() {
+
+    std::string_view verb = parseVerb();
+    MarsParsedRequest r(std::string(verb), line_ + 1);
+
+    char c = peek();
+    while (c == ',') {
+        consume(',');
+        std::string key = parseIndents();
+        consume('=');
+        r.values(key, parseValues());
+        c = peek();
+    }
+    if (c == '.') {
+        consume('.');
+    }
+
+    return r;
+}
+
+std::vector<MarsParsedRequest> MarsBufferParser::parse() {
+    std::vector<MarsParsedRequest> result;
+
+    while (peek() != 0) {
+        result.push_back(parseRequest());
+    }
+
+    return result;
+}
+
+void MarsBufferParser::parse(MarsParserCallback& cb) {
+
+    while (peek() != 0) {
+        auto r = parseRequest();
+        cb(r);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
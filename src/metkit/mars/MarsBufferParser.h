@@ -0,0 +1,68 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MarsBufferParser.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "metkit/mars/MarsParsedRequest.h"
+#include "metkit/mars/MarsParser.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Parser of MARS requests held in memory, e.g. a string or a memory-mapped file
+///
+/// Accepts the same grammar as MarsParser (comments, quoting, multi-word values), but scans the buffer in bulk rather
+/// than a character at a time through a stream. Tokens are views into the buffer, strings are only built for the
+/// parsed requests. The buffer must outlive the parser.
+class MarsBufferParser {
+public:  // methods
+
+    MarsBufferParser(const char* data, size_t size);
+    explicit MarsBufferParser(std::string_view buffer);
+
+    std::vector<MarsParsedRequest> parse();
+
+    /// Calls cb with each request as soon as it is parsed
+    void parse(MarsParserCallback& cb);
+
+private:  // methods
+
+    /// Next character, 0 at the end of the buffer. Comments are skipped, and so are spaces unless spaces is set
+    char peek(bool spaces = false);
+    char next(bool spaces = false);
+    void consume(char c);
+
+    MarsParsedRequest parseRequest();
+    std::string_view parseVerb();
+    std::string_view parseIndent();
+    std::string parseIndents();
+    std::vector<std::string> parseValues();
+    std::string parseValue();
+    std::string parseString(char quote);
+
+private:  // members
+
+    const char* pos_;
+    const char* end_;
+    size_t line_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -16,19 +16,45 @@
 
 #pragma once
 
-#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "metkit/mars/Parameter.h"
 
 namespace metkit::mars {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// @brief Mutable state carried from one expansion to the next, i.e. the values inherited by subsequent requests.
+/// A MarsLanguage is immutable and can be shared between threads, each sequence of requests owns its context.
 class MarsExpandContext {
+public:
 
-    void info(std::ostream&) const {}
+    void inherit(const std::string& keyword, const std::vector<std::string>& values) {
+        inheritance_[keyword] = Parameter(values);
+    }
 
-public:
+    /// Inherits the values of an expanded parameter, a range stays unexpanded
+    void inherit(const std::string& keyword, const Parameter& parameter) { inheritance_[keyword] = parameter; }
+
+    /// The inherited values of keyword, nullptr if there are none
+    const Parameter* inherited(const std::string& keyword) const {
+        auto it = inheritance_.find(keyword);
+        return it == inheritance_.end() ? nullptr : &it->second;
+    }
+
+    void reset(const std::string& keyword) { inheritance_.erase(keyword); }
+
+    void reset() { inheritance_.clear(); }
+
+    bool empty() const { return inheritance_.empty(); }
+
+    const std::map<std::string, Parameter>& inheritance() const { return inheritance_; }
+
+private:
 
-    friend std::ostream& operator<<(std::ostream& s, const MarsExpandContext& r) { return s; }
+    std::map<std::string, Parameter> inheritance_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
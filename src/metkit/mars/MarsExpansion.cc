@@ -10,6 +10,14 @@
 
 #include "metkit/mars/MarsExpansion.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include "eckit/config/Resource.h"
+
 #include "metkit/mars/MarsLanguage.h"
 
 
@@ -17,29 +25,29 @@ namespace metkit::mars {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-MarsExpansion::MarsExpansion(bool inherit, bool strict) : inherit_(inherit), strict_(strict) {}
+namespace {
 
-MarsExpansion::~MarsExpansion() {
-    for (auto& language : languages_) {
-        delete language.second;
-    }
+/// Cache shared by all the MarsExpansion objects of the process, if $METKIT_EXPAND_CACHE_SIZE is set
+std::shared_ptr<MarsExpansionCache> defaultCache() {
+    static size_t size = eckit::Resource<size_t>("metkitExpandCacheSize;$METKIT_EXPAND_CACHE_SIZE", 0);
+    static std::shared_ptr<MarsExpansionCache> cache = size ? std::make_shared<MarsExpansionCache>(size) : nullptr;
+    return cache;
 }
 
-void MarsExpansion::reset() {
-    for (auto& language : languages_) {
-        language.second->reset();
-    }
-}
+}  // namespace
 
-MarsLanguage& MarsExpansion::language(const std::string& verb) {
-    auto v = MarsLanguage::expandVerb(verb);
+//----------------------------------------------------------------------------------------------------------------------
 
-    if (auto j = languages_.find(v); j != languages_.end()) {
-        return *(*j).second;
-    }
+MarsExpansion::MarsExpansion(bool inherit, bool strict) : inherit_(inherit), strict_(strict), cache_(defaultCache()) {}
+
+MarsExpansion::~MarsExpansion() = default;
+
+void MarsExpansion::reset() {
+    contexts_.clear();
+}
 
-    auto j = languages_.emplace(v, new MarsLanguage(v)).first;
-    return *(*j).second;
+MarsExpandContext& MarsExpansion::context(const MarsLanguage& language) {
+    return contexts_[language.verb()];
 }
 
 
@@ -49,15 +57,175 @@ std::vector<MarsRequest> MarsExpansion::expand(const std::vector<MarsParsedReque
 
     // Implement inheritence
     for (const auto& request : requests) {
-        auto& lang = language(request.verb());
-        result.emplace_back(lang.expand(request, inherit_, strict_));
+        const auto& lang = MarsLanguage::instance(request.verb());
+        result.emplace_back(expand(lang, request, context(lang)));
+    }
+
+    return result;
+}
+
+namespace {
+
+/// Calls f(i) for each i in [0, n) on a pool of threads, keeping the error of each call in errors. Indices are handed
+/// out in order, none after a failure, and f is called with every index handed out. Returns the number of indices
+/// called, which are [0, returned)
+size_t forEachIndex(size_t n, size_t threads, std::vector<std::exception_ptr>& errors,
+                    const std::function<void(size_t)>& f) {
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+
+    auto worker = [&] {
+        while (!failed) {
+            size_t i = next++;
+            if (i >= n) {
+                break;
+            }
+            try {
+                f(i);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+                failed    = true;
+            }
+        }
+    };
+
+    threads = std::min(threads, n);
+    if (threads <= 1) {
+        worker();
+        return std::min<size_t>(next, n);
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    return std::min<size_t>(next, n);
+}
+
+}  // namespace
+
+std::vector<MarsRequest> MarsExpansion::expandBatch(const std::vector<MarsParsedRequest>& requests, size_t threads) {
+    static size_t defaultThreads = eckit::Resource<size_t>("metkitExpandThreads;$METKIT_EXPAND_THREADS", 0);
+
+    if (threads == 0) {
+        threads = defaultThreads != 0 ? defaultThreads : std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    const size_t n = requests.size();
+
+    std::vector<const MarsLanguage*> languages;
+    languages.reserve(n);
+    for (const auto& request : requests) {
+        languages.push_back(&MarsLanguage::instance(request.verb()));
+    }
+
+    std::vector<MarsLanguage::Expansion> expansions(n);
+    std::vector<MarsRequest> result(n);
+    std::vector<std::exception_ptr> errors(n);
+
+    // Phase 1: expand the values given in each request, which do not depend on the other requests
+
+    const size_t expanded =
+        forEachIndex(n, threads, errors, [&](size_t i) { expansions[i] = languages[i]->expandValues(requests[i]); });
+
+    // Phase 2: inherit from the previous requests, or take the defaults, in order. This updates the contexts as
+    // expand() does, so that batches and single requests can follow each other. Cached requests are complete. It stops
+    // at the first request that failed, or was not expanded after a failure.
+
+    std::vector<bool> cached(n, false);
+    std::vector<std::pair<MarsExpansionCache::Key, MarsExpandContext>> entries(cache_ ? n : 0);
+
+    size_t end = 0;
+    for (; end < expanded && !errors[end]; ++end) {
+        MarsExpandContext& ctx = context(*languages[end]);
+
+        if (cache_) {
+            auto key = MarsExpansionCache::key(requests[end], inherit_ ? &ctx : nullptr, strict_);
+            if (auto entry = cache_->find(key)) {
+                if (inherit_) {
+                    ctx = entry->context;
+                }
+                result[end] = entry->request;
+                cached[end] = true;
+                continue;
+            }
+            entries[end].first = std::move(key);
+        }
+
+        try {
+            languages[end]->inheritValues(requests[end], expansions[end], ctx, inherit_);
+        }
+        catch (...) {
+            errors[end] = std::current_exception();
+            break;
+        }
+
+        if (cache_ && inherit_) {
+            entries[end].second = ctx;
+        }
+    }
+
+    // Phase 3: finalise the requests before the first failure, which are now independent of each other
+
+    forEachIndex(end, threads, errors, [&](size_t i) {
+        if (!cached[i]) {
+            result[i] = languages[i]->finalise(requests[i], expansions[i], strict_);
+        }
+    });
+
+    for (const auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    if (cache_) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!cached[i]) {
+                auto entry = std::make_shared<const MarsExpansionCache::Entry>(
+                    MarsExpansionCache::Entry{result[i], std::move(entries[i].second)});
+                cache_->insert(entries[i].first, entry);
+            }
+        }
     }
 
     return result;
 }
 
 MarsRequest MarsExpansion::expand(const MarsRequest& request) {
-    return language(request.verb()).expand(request, inherit_, strict_);
+    const auto& lang = MarsLanguage::instance(request.verb());
+    return expand(lang, request, context(lang));
+}
+
+MarsRequest MarsExpansion::expand(const MarsLanguage& lang, const MarsRequest& request,
+                                  MarsExpandContext& context) const {
+    if (!cache_) {
+        return lang.expand(request, context, inherit_, strict_);
+    }
+
+    // Without inheritance, the context is never read and its state does not matter
+    auto key = MarsExpansionCache::key(request, inherit_ ? &context : nullptr, strict_);
+
+    if (auto entry = cache_->find(key)) {
+        if (inherit_) {
+            context = entry->context;
+        }
+        return entry->request;
+    }
+
+    MarsRequest result = lang.expand(request, context, inherit_, strict_);
+    cache_->insert(key, std::make_shared<const MarsExpansionCache::Entry>(
+                            MarsExpansionCache::Entry{result, inherit_ ? context : MarsExpandContext{}}));
+    return result;
+}
+
+void MarsExpansion::cache(std::shared_ptr<MarsExpansionCache> cache) {
+    cache_ = std::move(cache);
 }
 
 void MarsExpansion::expand(const MarsRequest& request, ExpandCallback& callback) {
@@ -65,7 +233,7 @@ void MarsExpansion::expand(const MarsRequest& request, ExpandCallback& callback)
 }
 
 void MarsExpansion::flatten(const MarsRequest& request, FlattenCallback& callback) {
-    language(request.verb()).flatten(request, callback);
+    MarsLanguage::instance(request.verb()).flatten(request, callback);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
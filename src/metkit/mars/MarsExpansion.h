@@ -20,9 +20,12 @@
 #include "eckit/memory/NonCopyable.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "metkit/mars/MarsExpandContext.h"
+#include "metkit/mars/MarsExpansionCache.h"
 #include "metkit/mars/MarsParsedRequest.h"
 #include "metkit/mars/MarsRequest.h"
 
@@ -65,16 +68,34 @@ public:
     MarsRequest expand(const MarsRequest&);
     std::vector<MarsRequest> expand(const std::vector<MarsParsedRequest>&);
 
+    /// Expands a batch of requests as expand() does, in three phases (see MarsLanguage::expandValues). The values given
+    /// in the requests are first expanded concurrently, then each request inherits from the previous ones in order,
+    /// and the completed requests are finalised concurrently. Results are returned in input order, and the inherited
+    /// values carry over to the next call to expand() or expandBatch(). If several requests fail, the error of the
+    /// first one is rethrown.
+    /// @param threads number of threads, 0 for the default ($METKIT_EXPAND_THREADS, or the number of cores)
+    std::vector<MarsRequest> expandBatch(const std::vector<MarsParsedRequest>&, size_t threads = 0);
+
     void expand(const MarsRequest&, ExpandCallback&);
     void flatten(const MarsRequest&, FlattenCallback&);
 
+    /// Cache of the expanded requests, used by all the expand methods. A repeated request, with the same inherited
+    /// values, is then returned without being expanded again. By default, a cache of $METKIT_EXPAND_CACHE_SIZE entries
+    /// is shared by all the MarsExpansion objects, there is no cache if it is not set. nullptr disables the cache
+    void cache(std::shared_ptr<MarsExpansionCache> cache);
+    const std::shared_ptr<MarsExpansionCache>& cache() const { return cache_; }
+
 private:
 
-    MarsLanguage& language(const std::string& verb);
+    MarsRequest expand(const MarsLanguage& lang, const MarsRequest& request, MarsExpandContext& context) const;
+
+    MarsExpandContext& context(const MarsLanguage& language);
 
-    std::map<std::string, MarsLanguage*> languages_;
+    /// Inherited values, per verb. The languages themselves are shared process-wide (see MarsLanguage::instance)
+    std::map<std::string, MarsExpandContext> contexts_;
     bool inherit_;
     bool strict_;
+    std::shared_ptr<MarsExpansionCache> cache_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,166 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MarsExpansionCache.cc
+/// @date   Oct 2026
+
+#include "metkit/mars/MarsExpansionCache.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/types/Date.h"
+#include "eckit/utils/StringTools.h"
+
+namespace metkit::mars {
+
+namespace {
+
+/// Unambiguous encoding of a sequence of strings, numbers and parameters
+class Encoder {
+public:
+
+    void add(const std::string& s) {
+        add(static_cast<long>(s.size()));  // length first, so that "ab","c" and "a","bc" differ
+        key_.append(s);
+    }
+
+    void add(long n) { key_.append(reinterpret_cast<const char*>(&n), sizeof(n)); }
+
+    void add(const Parameter& p) {
+        if (p.range()) {  // not materialised, the range is identified by its bounds
+            std::ostringstream oss;
+            oss << *p.range();
+            add(-1L);
+            add(oss.str());
+            return;
+        }
+        add(static_cast<long>(p.values().size()));
+        for (const auto& v : p.values()) {
+            add(v);
+        }
+    }
+
+    std::string& value() { return key_; }
+
+private:
+
+    std::string key_;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MarsExpansionCache::MarsExpansionCache(size_t capacity) : capacity_(capacity) {
+    ASSERT(capacity_ > 0);
+}
+
+std::shared_ptr<const MarsExpansionCache::Entry> MarsExpansionCache::find(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+}
+
+void MarsExpansionCache::insert(const Key& key, std::shared_ptr<const Entry> entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {  // inserted by another thread in the meantime
+        it->second->second = std::move(entry);
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.emplace_front(key, std::move(entry));
+    index_.emplace(lru_.front().first, lru_.begin());
+
+    if (lru_.size() > capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+void MarsExpansionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+}
+
+size_t MarsExpansionCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+MarsExpansionCache::Key MarsExpansionCache::key(const MarsRequest& request, const MarsExpandContext* context,
+                                                 bool strict) {
+    Encoder e;
+
+    e.add(eckit::Date(0).julian());
+    e.add(strict ? 1L : 0L);
+    e.add(request.verb());
+
+    std::vector<const Parameter*> params;
+    params.reserve(request.parameters().size());
+    for (const auto& p : request.parameters()) {
+        params.push_back(&p);
+    }
+    std::sort(params.begin(), params.end(),
+              [](const Parameter* a, const Parameter* b) { return a->keyword() < b->keyword(); });
+
+    e.add(static_cast<long>(params.size()));
+    for (const Parameter* p : params) {
+        e.add(p->name());
+        e.add(*p);
+    }
+
+    // Of several abbreviations of the same keyword, the expansion keeps the first one, so that their order matters
+    std::vector<std::string> names;
+    names.reserve(params.size());
+    for (const Parameter* p : params) {
+        names.push_back(eckit::StringTools::lower(p->name()));
+    }
+    std::sort(names.begin(), names.end());
+    for (size_t i = 1; i < names.size(); ++i) {
+        if (names[i].compare(0, names[i - 1].size(), names[i - 1]) == 0) {
+            for (const auto& p : request.parameters()) {
+                e.add(p.name());
+            }
+            break;
+        }
+    }
+
+    if (context) {
+        e.add(static_cast<long>(context->inheritance().size()));
+        for (const auto& [keyword, inherited] : context->inheritance()) {
+            e.add(keyword);
+            e.add(inherited);
+        }
+    }
+    else {
+        e.add(-1L);
+    }
+
+    return std::move(e.value());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -0,0 +1,87 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MarsExpansionCache.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "metkit/mars/MarsExpandContext.h"
+#include "metkit/mars/MarsRequest.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Bounded LRU cache of expanded requests, see MarsExpansion::cache()
+///
+/// Entries are keyed by a canonical encoding of the request to expand, of the context it inherits from and of the
+/// expansion options. Keys are compared in full, so that a request never gets the entry of another one, even when a
+/// cache is shared by several users. A cache can be shared by several MarsExpansion objects and used from several
+/// threads.
+class MarsExpansionCache {
+public:  // types
+
+    using Key = std::string;
+
+    struct Entry {
+        MarsRequest request;        // expanded request
+        MarsExpandContext context;  // context after the expansion
+    };
+
+public:  // methods
+
+    explicit MarsExpansionCache(size_t capacity);
+
+    /// The entry of the given key, nullptr if there is none
+    std::shared_ptr<const Entry> find(const Key& key);
+
+    void insert(const Key& key, std::shared_ptr<const Entry> entry);
+
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const { return capacity_; }
+
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+
+public:  // class methods
+
+    /// Key of a request and the context it inherits from (nullptr if there is no inheritance). The parameters are
+    /// encoded in the order of their keywords, so that requests differing in the order of their keywords only share a
+    /// key. Relative dates are expanded against the current date, which is part of the key
+    static Key key(const MarsRequest& request, const MarsExpandContext* context, bool strict);
+
+private:  // members
+
+    using LRU = std::list<std::pair<Key, std::shared_ptr<const Entry>>>;
+
+    const size_t capacity_;
+
+    mutable std::mutex mutex_;
+    LRU lru_;  // most recently used first
+    std::unordered_map<std::string_view, LRU::iterator> index_;  // viewing the keys held by lru_
+
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -11,19 +11,21 @@
 #include "metkit/mars/MarsLanguage.h"
 
 #include <algorithm>
-#include <fstream>
+#include <mutex>
 #include <optional>
 
 #include "eckit/config/Resource.h"
 #include "eckit/log/Log.h"
-#include "eckit/parser/YAMLParser.h"
 #include "eckit/types/Types.h"
 #include "eckit/utils/StringTools.h"
 
+#include "metkit/config/ConfigSnapshot.h"
 #include "metkit/config/LibMetkit.h"
 
 #include "metkit/hypercube/HyperCube.h"
+#include "metkit/mars/FlattenSpace.h"
 #include "metkit/mars/MarsExpansion.h"
+#include "metkit/mars/PrefixMatcher.h"
 #include "metkit/mars/Type.h"
 #include "metkit/mars/TypesFactory.h"
 
@@ -37,9 +39,9 @@ static std::set<std::string> verbs_;
 static std::map<std::string, std::string> verbAliases_;
 
 static void init() {
-    languages_ = eckit::YAMLParser::decodeFile(metkit::LibMetkit::languageYamlFile());
+    languages_ = metkit::ConfigSnapshot::decodeFile(metkit::LibMetkit::languageYamlFile());
     for (const auto& file : metkit::LibMetkit::modifiersYamlFiles()) {
-        modifiers_.push_back(eckit::YAMLParser::decodeFile(file));
+        modifiers_.push_back(metkit::ConfigSnapshot::decodeFile(file));
     }
     const eckit::Value verbs = languages_.keys();
     for (size_t i = 0; i < verbs.size(); ++i) {
@@ -208,6 +210,8 @@ MarsLanguage::MarsLanguage(const std::string& verb) {
             typesByAxisOrder_.emplace_back(k, t);
         }
     }
+
+    keywordMatcher_ = PrefixMatcher(keywords_, aliases_);
 }
 
 bool MarsLanguage::isData(const std::string& keyword) const {
@@ -236,9 +240,22 @@ eckit::PathName MarsLanguage::languageYamlFile() {
 }
 
 void MarsLanguage::reset() {
-    for (auto& [k, t] : types_) {
-        t->reset();
+    context_.reset();
+}
+
+const MarsLanguage& MarsLanguage::instance(const std::string& verb) {
+    // Never deleted: requests may still reference the types of a language during static destruction
+    static std::mutex mutex;
+    static auto* languages = new std::map<std::string, std::unique_ptr<MarsLanguage>>();
+
+    std::string v = expandVerb(verb);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto j = languages->find(v);
+    if (j == languages->end()) {
+        j = languages->emplace(v, std::make_unique<MarsLanguage>(v)).first;
     }
+    return *j->second;
 }
 
 eckit::Value MarsLanguage::jsonFile(const std::string& name) {
@@ -248,153 +265,16 @@ eckit::Value MarsLanguage::jsonFile(const std::string& name) {
 
     LOG_DEBUG_LIB(LibMetkit) << "MarsLanguage loading jsonFile " << path << std::endl;
 
-    std::ifstream in(path.asString().c_str());
-    if (!in) {
+    if (!path.exists()) {
         throw eckit::CantOpenFile(path);
     }
 
-    eckit::YAMLParser parser(in);
-
-    return parser.parse();
+    return metkit::ConfigSnapshot::decodeFile(path);
 }
 
-static bool isnumeric(const std::string& s) {
-    for (size_t i = 0; i < s.length(); i++) {
-        if (!::isdigit(s[i])) {
-            return false;
-        }
-    }
-
-    return s.length() > 0;
-}
-
-
 std::string MarsLanguage::bestMatch(const std::string& name, const std::vector<std::string>& values, bool fail,
                                     bool quiet, bool fullMatch, const std::map<std::string, std::string>& aliases) {
-    size_t score = (fullMatch ? name.length() : 1);
-    std::vector<std::string> best;
-
-    for (size_t i = 0; i < values.size(); ++i) {
-        const std::string& value = values[i];
-
-        size_t len = std::min(name.length(), value.length());
-        size_t s   = 0;
-
-        // Prefix comparison, break if there is a difference
-        for (size_t j = 0; j < len; ++j) {
-            if (::tolower(name[j]) == ::tolower(value[j])) {
-                s++;
-            }
-            else {
-                break;
-            }
-        }
-
-        // if value and name are the same (in lowercase), look up aliases and return the alias
-        // otherwise return the value (which is name)
-        if (s == value.length() && s == name.length()) {
-            if (aliases.find(value) != aliases.end()) {
-                return aliases.find(value)->second;
-            }
-            return value;
-        }
-
-        // If fullmatch == true:
-        // only option is s==score, otherwise the break above would have triggered
-        // so best is only filled with exact matches
-        // If fullmatch == false:
-        // score keeps track of the best value found, if a better value (in terms of matching prefixes)
-        // is found, clear the best vector and push the new best. If all matches are equally good, keep them in the best
-        // vector
-        if (s >= score) {
-            if (s > score) {
-                best.clear();
-            }
-            best.push_back(value);
-            score = s;
-        }
-    }
-
-    if (!quiet && best.size() > 0) {
-        std::cerr << "Matching '" << name << "' with " << best << std::endl;
-    }
-
-    static bool strict = eckit::Resource<bool>("$METKIT_LANGUAGE_STRICT_MODE", true);
-    if (best.size() == 1) {
-        // If the best entry is a number or not name (why is this even needed)
-        if (isnumeric(best[0]) && (best[0] != name)) {
-            best.clear();
-        }
-        else {
-            if (strict) {
-                if (best[0] != name) {
-                    std::ostringstream oss;
-                    oss << "Cannot match [" << name << "] in " << values;
-                    throw eckit::UserError(oss.str());
-                }
-            }
-
-            if (aliases.find(best[0]) != aliases.end()) {
-                return aliases.find(best[0])->second;
-            }
-            return best[0];
-        }
-    }
-
-    // In case the match is empty, return or fail, depending on the fail flag
-    static std::string empty;
-    if (best.empty()) {
-        if (!fail) {
-            return empty;
-        }
-
-        std::ostringstream oss;
-        oss << "Cannot match [" << name << "] in " << values;
-        throw eckit::UserError(oss.str());
-    }
-
-    // Check the existing aliases for mappings of the matches to the canonical parameter name
-    // A set is used to de-duplicate the findings
-    std::set<std::string> names;
-    for (std::vector<std::string>::const_iterator j = best.begin(); j != best.end(); ++j) {
-        const auto k = aliases.find(*j);
-        if (k == aliases.end()) {
-            names.insert(*j);
-        }
-        else {
-            names.insert((*k).second);
-        }
-    }
-
-    // If there is only on match return the given one
-    if (names.size() == 1) {
-        if (aliases.find(best[0]) != aliases.end()) {
-            return aliases.find(best[0])->second;
-        }
-        return best[0];
-    }
-
-    // Otherwise there is an ambiguity and we want to return or fail (depending on the fail flag)
-    if (!fail) {
-        return empty;
-    }
-
-    std::ostringstream oss;
-    oss << "Ambiguous value '" << name << "' could be";
-
-    for (std::vector<std::string>::const_iterator j = best.begin(); j != best.end(); ++j) {
-        auto k = aliases.find(*j);
-        if (k == aliases.end()) {
-            oss << " '" << *j << "'";
-        }
-        else {
-            oss << " '" << *j << "' (";
-            oss << (*k).second;
-            oss << ")";
-        }
-    }
-
-    throw eckit::UserError(oss.str());
+    return PrefixMatcher(values, aliases).match(name, fail, quiet, fullMatch);
 }
 
 std::string MarsLanguage::expandVerb(const std::string& verb) {
@@ -439,126 +319,194 @@ Type* MarsLanguage::type(const std::string& name) const {
 }
 
 
+std::string MarsLanguage::keyword(const std::string& name) const {
+    return keywordMatcher_.match(eckit::StringTools::lower(name), true, false, true);
+}
+
 MarsRequest MarsLanguage::expand(const MarsRequest& r, bool inherit, bool strict) {
-    MarsRequest result(verb_);
+    return expand(r, context_, inherit, strict);
+}
+
+namespace {
 
+/// Reports an error expanding r as a UserError, with the request expanded so far
+template <typename F>
+void reportingErrors(const MarsRequest& r, const MarsRequest& result, F&& f) {
     try {
-        std::vector<std::pair<std::string, std::string>> sortedParams;
-        std::map<std::string, std::string> paramSet;
-        std::vector<std::string> params;
-
-        for (const auto& PP : r.params()) {
-            auto c = cache_.find(PP);
-            if (c != cache_.end()) {
-                paramSet.emplace((*c).second, PP);
-            }
-            else {
-                std::string p = eckit::StringTools::lower(PP);
-                paramSet.emplace(cache_[p] = bestMatch(p, keywords_, true, false, true, aliases_), PP);
+        f();
+    }
+    catch (std::exception& e) {
+        std::ostringstream oss;
+        oss << e.what() << " request=" << r << ", expanded=" << result;
+        throw eckit::UserError(oss.str());
+    }
+}
+
+}  // namespace
+
+MarsRequest MarsLanguage::expand(const MarsRequest& r, MarsExpandContext& context, bool inherit, bool strict) const {
+    Expansion e{MarsRequest(verb_), {}};
+
+    reportingErrors(r, e.result, [&] {
+        // Contexts are evaluated against the request as it is being completed, each condition at most once as long as
+        // the keyword it tests does not change
+        ContextCache cache;
+
+        expandValues(r, e);
+        inheritValues(e, context, inherit, cache);
+        finalise(e.result, strict, cache);
+    });
+
+    return std::move(e.result);
+}
+
+MarsLanguage::Expansion MarsLanguage::expandValues(const MarsRequest& r) const {
+    Expansion e{MarsRequest(verb_), {}};
+    reportingErrors(r, e.result, [&] { expandValues(r, e); });
+    return e;
+}
+
+void MarsLanguage::inheritValues(const MarsRequest& r, Expansion& e, MarsExpandContext& context, bool inherit) const {
+    reportingErrors(r, e.result, [&] {
+        ContextCache cache;
+        inheritValues(e, context, inherit, cache);
+    });
+}
+
+MarsRequest MarsLanguage::finalise(const MarsRequest& r, Expansion& e, bool strict) const {
+    reportingErrors(r, e.result, [&] {
+        ContextCache cache;
+        finalise(e.result, strict, cache);
+    });
+    return std::move(e.result);
+}
+
+void MarsLanguage::expandValues(const MarsRequest& r, Expansion& e) const {
+    MarsRequest& result = e.result;
+
+    std::vector<std::pair<std::string, std::string>> sortedParams;
+    std::map<std::string, std::string> paramSet;
+
+    for (const auto& PP : r.params()) {
+        paramSet.emplace(keyword(PP), PP);
+    }
+
+    {  // sort the parameters, following the AxisOrder
+        for (const auto& k : metkit::hypercube::AxisOrder::instance().axes()) {
+            auto it = paramSet.find(k);
+            if (it != paramSet.end()) {
+                sortedParams.emplace_back(k, it->second);
+                paramSet.erase(it);
             }
         }
+        for (const auto& [k, PP] : paramSet) {
+            sortedParams.emplace_back(k, PP);
+        }
+    }
 
-        {  // sort the parameters, following the AxisOrder
-            for (const auto& k : metkit::hypercube::AxisOrder::instance().axes()) {
-                auto it = paramSet.find(k);
-                if (it != paramSet.end()) {
-                    sortedParams.emplace_back(k, it->second);
-                    paramSet.erase(it);
-                }
+    for (const auto& [p, PP] : sortedParams) {
+        std::vector<std::string> values = r.values(PP);
+
+        if (values.size() == 1) {
+            const std::string& s = eckit::StringTools::lower(values[0]);
+            if (s == "off") {
+                result.unsetValues(p);
+                e.resets.push_back(p);
+                continue;
             }
-            for (const auto& [k, PP] : paramSet) {
-                sortedParams.emplace_back(k, PP);
+            if (s == "all" && type(p)->multiple()) {
+                result.setValue(p, "all");
+                continue;
             }
         }
 
-        for (const auto& [p, PP] : sortedParams) {
-            std::vector<std::string> values = r.values(PP);
+        auto t = type(p);
+        // Only lists of a type accepting all the values between valid bounds are kept unexpanded, they need no
+        // checking (see Type::acceptsRanges())
+        if (auto range = t->range(values, result)) {
+            result.setValuesTyped(t, std::move(range));
+            continue;
+        }
+        t->expand(values, result);
+        result.setValuesTyped(t, values);
+        t->check(values);
+    }
+}
 
-            if (values.size() == 1) {
-                const std::string& s = eckit::StringTools::lower(values[0]);
-                if (s == "off") {
-                    result.unsetValues(p);
-                    type(p)->reset();
-                    continue;
+void MarsLanguage::inheritValues(Expansion& e, MarsExpandContext& context, bool inherit, ContextCache& cache) const {
+    MarsRequest& result = e.result;
+
+    for (const auto& k : e.resets) {
+        context.reset(k);
+    }
+
+    if (inherit) {
+        for (const auto& [k, t] : typesByAxisOrder_) {
+            if (t != nullptr && result.countValues(k) == 0) {
+                if (const Parameter* inherited = context.inherited(k)) {
+                    if (inherited->range()) {
+                        result.setValuesTyped(t, inherited->range());
+                    }
+                    else {
+                        result.setValuesTyped(t, inherited->values());
+                    }
+                    cache.invalidate(t->keyId_);
                 }
-                if (s == "all" && type(p)->multiple()) {
-                    result.setValue(p, "all");
-                    continue;
+                else {
+                    t->setDefaults(result, cache);
                 }
             }
+        }
 
-            auto t = type(p);
-            t->expand(values, result);
-            result.setValuesTyped(t, values);
-            t->check(values);
+        for (const Parameter& p : result.parameters()) {
+            context.inherit(p.name(), p);
         }
+    }
+}
 
-        if (inherit) {
-            for (const auto& [k, t] : typesByAxisOrder_) {
-                if (t != nullptr && result.countValues(k) == 0) {
-                    t->setDefaults(result);
-                }
-            }
+void MarsLanguage::finalise(MarsRequest& result, bool strict, ContextCache& cache) const {
+    std::vector<std::string> params;
+    result.getParams(params);
 
-            result.getParams(params);
-            for (std::vector<std::string>::const_iterator k = params.begin(); k != params.end(); ++k) {
-                type(*k)->setInheritance(result.values(*k));
-            }
-        }
+    for (std::vector<std::string>::const_iterator k = params.begin(); k != params.end(); ++k) {
+        const Type* t = type(*k);
+        t->pass2(result);
+        cache.invalidate(t->keyId_);
+    }
+
+    for (const auto& [k, t] : typesByAxisOrder_) {
+        if (t != nullptr)
+            t->finalise(result, strict, cache);
+    }
+}
 
-        result.getParams(params);
+MarsRequest MarsLanguage::compact(const MarsRequest& r) const {
+    MarsRequest result(r);
 
-        for (std::vector<std::string>::const_iterator k = params.begin(); k != params.end(); ++k) {
-            type(*k)->pass2(result);
+    for (const auto& p : r.parameters()) {
+        auto t = types_.find(p.name());
+        if (t == types_.end() || p.size() < 3) {
+            continue;
         }
 
-        for (const auto& [k, t] : typesByAxisOrder_) {
-            if (t != nullptr)
-                t->finalise(result, strict);
+        std::vector<std::string> values = p.values();
+        t->second->compact(values, r);
+        if (values.size() < p.size()) {
+            result.values(p.name(), values);
         }
     }
-    catch (std::exception& e) {
-        std::ostringstream oss;
-        oss << e.what() << " request=" << r << ", expanded=" << result;
-        throw eckit::UserError(oss.str());
-    }
+
     return result;
 }
 
-
 const std::string& MarsLanguage::verb() const {
     return verb_;
 }
 
-void MarsLanguage::flatten(const MarsRequest& request, const std::vector<std::string>& params, size_t i,
-                           MarsRequest& result, FlattenCallback& callback) {
-    if (i == params.size()) {
-        callback(result);
-        return;
+void MarsLanguage::flatten(const MarsRequest& request, FlattenCallback& callback) const {
+    for (const MarsRequest& field : FlattenSpace(*this, request)) {
+        callback(field);
     }
-
-    const std::string& param = params[i];
-
-    Type* t = type(param);
-    if (!t->flatten()) {
-        flatten(request, params, i + 1, result, callback);
-        return;
-    }
-
-    const std::vector<std::string>& values = t->flattenValues(request);
-
-    for (std::vector<std::string>::const_iterator j = values.begin(); j != values.end(); ++j) {
-        result.setValue(param, *j);
-        flatten(request, params, i + 1, result, callback);
-    }
-}
-
-void MarsLanguage::flatten(const MarsRequest& request, FlattenCallback& callback) {
-    std::vector<std::string> params;
-    request.getParams(params);
-
-    MarsRequest result(request);
-    flatten(request, params, 0, result, callback);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -24,12 +24,15 @@
 
 #include "eckit/memory/NonCopyable.h"
 
+#include "metkit/mars/MarsExpandContext.h"
 #include "metkit/mars/MarsRequest.h"
+#include "metkit/mars/PrefixMatcher.h"
 
 
 namespace metkit::mars {
 
 class Context;
+class ContextCache;
 class FlattenCallback;
 class Type;
 
@@ -51,13 +54,41 @@ public:  // methods
 
     ~MarsLanguage();
 
+    /// Expands a request, inheriting from (and updating) the given context. The language itself is not modified, so
+    /// one language can be shared by many threads as long as each of them uses its own context
+    MarsRequest expand(const MarsRequest& r, MarsExpandContext& context, bool inherit, bool strict) const;
+
+    /// A request part way through its expansion, see expandValues()
+    struct Expansion {
+        MarsRequest result;               // the request expanded so far
+        std::vector<std::string> resets;  // the keywords set to "off", to be reset in the context
+    };
+
+    /// The steps of expand(), run separately by a batch expansion (see MarsExpansion::expandBatch). Only
+    /// inheritValues() depends on the requests expanded before, so that expandValues() and finalise() can run on many
+    /// requests concurrently. Errors are reported as by expand(), r being the request as given.
+    ///
+    /// expandValues() expands the values given in the request. inheritValues() resets the keywords set to "off" in
+    /// the context then, if inherit is set, completes the request with the values inherited from the context or the
+    /// defaults, and updates the context. finalise() applies the rules of the language and returns the request.
+    Expansion expandValues(const MarsRequest& r) const;
+    void inheritValues(const MarsRequest& r, Expansion& e, MarsExpandContext& context, bool inherit) const;
+    MarsRequest finalise(const MarsRequest& r, Expansion& e, bool strict) const;
+
+    /// Rewrites the runs of evenly spaced values of an expanded request (dates, steps, levels, ...) as from/to/by
+    /// lists where this makes the request shorter, e.g. step=0/6/12/18/24/30 becomes step=0/to/30/by/6. The result is
+    /// no longer expanded, and expands back to the same fields. Keywords unknown to the language are left as they are
+    MarsRequest compact(const MarsRequest& r) const;
+
+    /// Expands a request, inheriting from the previous requests expanded by this object
     MarsRequest expand(const MarsRequest& r, bool inherit, bool strict);
 
     void reset();
 
     const std::string& verb() const;
 
-    void flatten(const MarsRequest& request, FlattenCallback& callback);
+    /// Calls the callback for each field of the request, see FlattenSpace
+    void flatten(const MarsRequest& request, FlattenCallback& callback) const;
 
     static eckit::PathName languageYamlFile();
 
@@ -72,8 +103,13 @@ public:  // methods
 
 public:  // class methods
 
+    /// Process-wide language for the given verb, built on first use and never modified afterwards
+    static const MarsLanguage& instance(const std::string& verb);
+
     static std::string expandVerb(const std::string& verb);
 
+    /// Matches a name against values once. Names matched repeatedly against the same values should go through a
+    /// PrefixMatcher built once for them
     static std::string bestMatch(const std::string& name, const std::vector<std::string>& values, bool fail, bool quiet,
                                  bool fullMatch, const std::map<std::string, std::string>& aliases = {});
 
@@ -82,8 +118,12 @@ public:  // class methods
 
 private:  // methods
 
-    void flatten(const MarsRequest& request, const std::vector<std::string>& params, size_t i, MarsRequest& result,
-                 FlattenCallback& callback);
+    std::string keyword(const std::string& name) const;
+
+    void expandValues(const MarsRequest& r, Expansion& e) const;
+    void inheritValues(Expansion& e, MarsExpandContext& context, bool inherit, ContextCache& cache) const;
+    void finalise(MarsRequest& result, bool strict, ContextCache& cache) const;
+
     void parseModifier(ModifierType typ, std::shared_ptr<Context> ctx, size_t maxIndex, const eckit::Value& mod);
 
 private:  // members
@@ -97,8 +137,9 @@ private:  // members
     std::vector<std::string> keywords_;
 
     std::map<std::string, std::string> aliases_;
+    PrefixMatcher keywordMatcher_;  // keywords and aliases, to their canonical keyword
 
-    mutable std::map<std::string, std::string> cache_;
+    MarsExpandContext context_;  // only used by the non-const expand()
 };
 
 //----------------------------------------------------------------------------------------------------------------------
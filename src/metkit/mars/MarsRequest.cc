@@ -8,6 +8,8 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+
 #include "eckit/log/JSON.h"
 #include "eckit/log/Log.h"
 #include "eckit/types/Types.h"
@@ -16,6 +18,8 @@
 
 #include "eckit/message/Message.h"
 #include "metkit/config/LibMetkit.h"
+#include "metkit/mars/Keyword.h"
+#include "metkit/mars/MarsBufferParser.h"
 #include "metkit/mars/MarsExpansion.h"
 #include "metkit/mars/MarsParser.h"
 #include "metkit/mars/MarsRequest.h"
@@ -103,7 +107,7 @@ void MarsRequest::encode(eckit::Stream& s) const {
     s << size;
 
 
-    for (std::list<Parameter>::const_iterator i = params_.begin(); i != params_.end(); ++i) {
+    for (std::vector<Parameter>::const_iterator i = params_.begin(); i != params_.end(); ++i) {
         s << (*i).name();
 
         const std::vector<std::string>& v = (*i).values();
@@ -127,8 +131,8 @@ void MarsRequest::print(std::ostream& s) const {
 }
 
 void MarsRequest::dump(std::ostream& s, const char* cr, const char* tab, bool verb) const {
-    std::list<Parameter>::const_iterator begin = params_.begin();
-    std::list<Parameter>::const_iterator end   = params_.end();
+    std::vector<Parameter>::const_iterator begin = params_.begin();
+    std::vector<Parameter>::const_iterator end   = params_.end();
 
     if (verb) {
         s << verb_ << ',';
@@ -139,7 +143,7 @@ void MarsRequest::dump(std::ostream& s, const char* cr, const char* tab, bool ve
         separator = ",";
 
         int a = 0;
-        for (std::list<Parameter>::const_iterator i = begin; i != end; ++i) {
+        for (std::vector<Parameter>::const_iterator i = begin; i != end; ++i) {
             if (a++) {
                 s << ',';
                 s << cr << tab;
@@ -168,10 +172,10 @@ void MarsRequest::dump(std::ostream& s, const char* cr, const char* tab, bool ve
 void MarsRequest::json(eckit::JSON& s, bool array) const {
     s.startObject();
     // s << "_verb" << verb_;
-    std::list<Parameter>::const_iterator begin = params_.begin();
-    std::list<Parameter>::const_iterator end   = params_.end();
+    std::vector<Parameter>::const_iterator begin = params_.begin();
+    std::vector<Parameter>::const_iterator end   = params_.end();
 
-    for (std::list<Parameter>::const_iterator i = begin; i != end; ++i) {
+    for (std::vector<Parameter>::const_iterator i = begin; i != end; ++i) {
         s << (*i).name();
         const std::vector<std::string>& v = (*i).values();
 
@@ -199,14 +203,14 @@ void MarsRequest::md5(eckit::MD5& md5) const {
 }
 
 void MarsRequest::unsetValues(const std::string& name) {
-    std::list<Parameter>::iterator i = find(name);
+    std::vector<Parameter>::iterator i = find(name);
     if (i != params_.end()) {
         params_.erase(i);
     }
 }
 
-void MarsRequest::setValuesTyped(Type* type, const std::vector<std::string>& values) {
-    std::list<Parameter>::iterator i = find(type->name());
+void MarsRequest::setValuesTyped(const Type* type, const std::vector<std::string>& values) {
+    std::vector<Parameter>::iterator i = find(type->name());
     if (i != params_.end()) {
         (*i) = Parameter(values, type);
     }
@@ -215,10 +219,20 @@ void MarsRequest::setValuesTyped(Type* type, const std::vector<std::string>& val
     }
 }
 
+void MarsRequest::setValuesTyped(const Type* type, std::shared_ptr<const ValueRange> range) {
+    std::vector<Parameter>::iterator i = find(type->name());
+    if (i != params_.end()) {
+        (*i) = Parameter(std::move(range), type);
+    }
+    else {
+        params_.push_back(Parameter(std::move(range), type));
+    }
+}
+
 bool MarsRequest::filter(const MarsRequest& filter) {
-    for (std::list<Parameter>::iterator i = params_.begin(); i != params_.end(); ++i) {
+    for (std::vector<Parameter>::iterator i = params_.begin(); i != params_.end(); ++i) {
         if ((*i).name() == "date") {
-            std::list<Parameter>::const_iterator j = filter.find("day");
+            std::vector<Parameter>::const_iterator j = filter.find("day");
             if (j != filter.params_.end()) {
                 if (!(*i).filter("day", (*j).values())) {
                     return false;
@@ -226,12 +240,12 @@ bool MarsRequest::filter(const MarsRequest& filter) {
             }
         }
 
-        std::list<Parameter>::const_iterator j = filter.find((*i).name());
+        std::vector<Parameter>::const_iterator j = filter.find((*i).name());
         if (j == filter.params_.end()) {
             continue;
         }
 
-        if (!(*i).filter((*j).values())) {
+        if (!(*i).filter(*j)) {
             return false;
         }
     }
@@ -239,14 +253,13 @@ bool MarsRequest::filter(const MarsRequest& filter) {
 }
 
 bool MarsRequest::matches(const MarsRequest& matches) const {
-    std::vector<std::string> params = matches.params();
-    for (std::vector<std::string>::const_iterator j = params.begin(); j != params.end(); ++j) {
-        std::list<Parameter>::const_iterator k = find(*j);
+    for (const Parameter& p : matches.params_) {
+        std::vector<Parameter>::const_iterator k = find(p.name());
         if (k == params_.end()) {
             return false;
         }
 
-        if (!(*k).matches(matches.values(*j))) {
+        if (!(*k).matches(p)) {
             return false;
         }
     }
@@ -255,7 +268,7 @@ bool MarsRequest::matches(const MarsRequest& matches) const {
 }
 
 void MarsRequest::values(const std::string& name, const std::vector<std::string>& v) {
-    std::list<Parameter>::iterator i = find(name);
+    std::vector<Parameter>::iterator i = find(name);
     if (i != params_.end()) {
         (*i).values(v);
     }
@@ -266,9 +279,9 @@ void MarsRequest::values(const std::string& name, const std::vector<std::string>
 
 
 size_t MarsRequest::countValues(const std::string& name) const {
-    std::list<Parameter>::const_iterator i = find(name);
+    std::vector<Parameter>::const_iterator i = find(name);
     if (i != params_.end()) {
-        return (*i).values().size();
+        return (*i).size();
     }
     return 0;
 }
@@ -279,7 +292,7 @@ bool MarsRequest::has(const std::string& name) const {
 
 
 bool MarsRequest::is(const std::string& name, const std::string& value) const {
-    std::list<Parameter>::const_iterator i = find(name);
+    std::vector<Parameter>::const_iterator i = find(name);
     if (i != params_.end()) {
         const std::vector<std::string>& v = (*i).values();
         return v.size() == 1 && v[0] == value;
@@ -288,7 +301,7 @@ bool MarsRequest::is(const std::string& name, const std::string& value) const {
 }
 
 const std::vector<std::string>& MarsRequest::values(const std::string& name, bool emptyOk) const {
-    std::list<Parameter>::const_iterator i = find(name);
+    std::vector<Parameter>::const_iterator i = find(name);
     if (i == params_.end()) {
         if (emptyOk) {
             static std::vector<std::string> empty;
@@ -304,7 +317,7 @@ const std::vector<std::string>& MarsRequest::values(const std::string& name, boo
 
 std::optional<std::reference_wrapper<const std::vector<std::string>>> MarsRequest::get(
     const std::string& keyword) const {
-    std::list<Parameter>::const_iterator i = find(keyword);
+    std::vector<Parameter>::const_iterator i = find(keyword);
     if (i == params_.end()) {
         return std::nullopt;
     }
@@ -312,7 +325,7 @@ std::optional<std::reference_wrapper<const std::vector<std::string>>> MarsReques
 }
 
 const std::string& MarsRequest::operator[](const std::string& name) const {
-    std::list<Parameter>::const_iterator i = find(name);
+    std::vector<Parameter>::const_iterator i = find(name);
     if (i == params_.end()) {
         std::ostringstream oss;
         oss << "Parameter '" << name << "' is undefined";
@@ -331,7 +344,7 @@ const std::string& MarsRequest::operator[](const std::string& name) const {
 
 void MarsRequest::getParams(std::vector<std::string>& p) const {
     p.clear();
-    for (std::list<Parameter>::const_iterator i = params_.begin(); i != params_.end(); ++i) {
+    for (std::vector<Parameter>::const_iterator i = params_.begin(); i != params_.end(); ++i) {
         p.push_back((*i).name());
     }
 }
@@ -348,11 +361,11 @@ size_t MarsRequest::count() const {
     bool hasLevelOne         = false;
 
     for (const auto& p : params_) {
-        if (p.values().size() == 1 && (p.values().at(0) == "all" || p.values().at(0) == "any")) {
+        if (p.size() == 1 && (p.values().at(0) == "all" || p.values().at(0) == "any")) {
             return 0;
         }
         if (p.name() == "levelist") {
-            levels = p.values().size();
+            levels = p.size();
             // For a parameter matching paramIdsSingleLevel, we can only include one value, and for level=1
             hasLevelOne = std::find(p.values().begin(), p.values().end(), "1") != p.values().end();
         }
@@ -456,9 +469,28 @@ void MarsRequest::merge(const MarsRequest& other) {
     }
 }
 
+MarsRequest::Merger::Merger(const MarsRequest& first) : request_(first) {
+    seen_.reserve(request_.params_.size());
+    for (const auto& param : request_.params_) {
+        seen_.emplace_back(param.values().begin(), param.values().end());
+    }
+}
+
+void MarsRequest::Merger::add(const MarsRequest& other) {
+    for (size_t i = 0; i < request_.params_.size(); ++i) {
+        Parameter& param = request_.params_[i];
+
+        auto it = std::find_if(other.params_.begin(), other.params_.end(),
+                               [&param](const Parameter& p) { return p.keyword() == param.keyword(); });
+        if (it != other.params_.end()) {
+            param.merge(*it, seen_[i]);
+        }
+    }
+}
+
 MarsRequest MarsRequest::subset(const std::set<std::string>& keys) const {
     MarsRequest req(verb_);
-    for (std::list<Parameter>::const_iterator it = params_.begin(); it != params_.end(); ++it) {
+    for (std::vector<Parameter>::const_iterator it = params_.begin(); it != params_.end(); ++it) {
         if (keys.find(it->name()) != keys.end()) {
             req.params_.push_back(*it);
         }
@@ -469,7 +501,7 @@ MarsRequest MarsRequest::subset(const std::set<std::string>& keys) const {
 
 MarsRequest MarsRequest::extract(const std::string& category) const {
     MarsRequest req(verb_);
-    for (std::list<Parameter>::const_iterator it = params_.begin(); it != params_.end(); ++it) {
+    for (std::vector<Parameter>::const_iterator it = params_.begin(); it != params_.end(); ++it) {
         if (it->type().category() == category) {
             req.params_.push_back(*it);
         }
@@ -499,22 +531,20 @@ const std::string& MarsRequest::verb() const {
     return verb_;
 }
 
-std::list<Parameter>::const_iterator MarsRequest::find(const std::string& name) const {
-    for (std::list<Parameter>::const_iterator i = params_.begin(); i != params_.end(); ++i) {
-        if ((*i).name() == name) {
-            return i;
-        }
+std::vector<Parameter>::const_iterator MarsRequest::find(const std::string& name) const {
+    const uint32_t keyword = Keyword::find(name);
+    if (keyword == Keyword::none) {
+        return params_.end();
     }
-    return params_.end();
+    return std::find_if(params_.begin(), params_.end(), [keyword](const Parameter& p) { return p.keyword() == keyword; });
 }
 
-std::list<Parameter>::iterator MarsRequest::find(const std::string& name) {
-    for (std::list<Parameter>::iterator i = params_.begin(); i != params_.end(); ++i) {
-        if ((*i).name() == name) {
-            return i;
-        }
+std::vector<Parameter>::iterator MarsRequest::find(const std::string& name) {
+    const uint32_t keyword = Keyword::find(name);
+    if (keyword == Keyword::none) {
+        return params_.end();
     }
-    return params_.end();
+    return std::find_if(params_.begin(), params_.end(), [keyword](const Parameter& p) { return p.keyword() == keyword; });
 }
 
 void MarsRequest::erase(const std::string& name) {
@@ -538,8 +568,9 @@ std::vector<MarsRequest> MarsRequest::parse(std::istream& in, bool strict) {
 }
 
 MarsRequest MarsRequest::parse(const std::string& s, bool strict) {
-    std::istringstream in(s);
-    std::vector<MarsRequest> v = parse(in, strict);
+    MarsBufferParser parser(s);
+    MarsExpansion expand(true, strict);
+    std::vector<MarsRequest> v = expand.expand(parser.parse());
     ASSERT(v.size() == 1);
     return v[0];
 }
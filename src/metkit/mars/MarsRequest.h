@@ -18,6 +18,9 @@
 #define metkit_MarsRequest_H
 
 #include <optional>
+#include <unordered_set>
+
+#include "eckit/exception/Exceptions.h"
 #include "eckit/value/Value.h"
 #include "metkit/mars/Parameter.h"
 
@@ -38,6 +41,13 @@ class MarsRequest;
 //----------------------------------------------------------------------------------------------------------------------
 
 class MarsRequest {
+public:  // types
+
+    /// The parameters of a request, in insertion order. Code outside metkit should name this type rather than the
+    /// container. As the parameters are contiguous, adding one (values(), setValue(), ...) invalidates the references
+    /// and iterators to the others
+    using Parameters = std::vector<Parameter>;
+
 public:  // methods
 
     MarsRequest();
@@ -77,9 +87,9 @@ public:  // methods
     void getParams(std::vector<std::string>&) const;
     std::vector<std::string> params() const;
 
-    std::list<Parameter>& parameters() { return params_; }
+    Parameters& parameters() { return params_; }
 
-    const std::list<Parameter>& parameters() const { return params_; }
+    const Parameters& parameters() const { return params_; }
 
     void verb(const std::string&);
 
@@ -98,10 +108,18 @@ public:  // methods
     /// Splits a MARS request into multiple requests along the indicated keys
     std::vector<MarsRequest> split(const std::vector<std::string>& keys) const;
 
-    /// Merges one MarsRequest into another
-    /// @todo Improve performance -- uses O(N^2) search / merge in std::list's
+    /// Merges one MarsRequest into another: the values of other are appended to the parameters of this request,
+    /// unless already present. Parameters only present in other are ignored
     void merge(const MarsRequest& other);
 
+    /// Merges a non-empty range of requests into (a copy of) the first one, see merge(other). Linear in the total
+    /// number of values, where merging the requests one by one would be quadratic
+    template <class Iterator>
+    static MarsRequest merge(Iterator begin, Iterator end);
+
+    /// Accumulates requests into one, see merge(begin, end)
+    class Merger;
+
     /// Create a new MarsRequest from this one with only the given set of keys
     MarsRequest subset(const std::set<std::string>&) const;
 
@@ -111,7 +129,9 @@ public:  // methods
 
     void dump(std::ostream&, const char* cr = "\n", const char* tab = "\t", bool verb = true) const;
 
-    void setValuesTyped(Type*, const std::vector<std::string>&);
+    void setValuesTyped(const Type*, const std::vector<std::string>&);
+    /// Sets the values as a range, expanded on demand, see Type::range()
+    void setValuesTyped(const Type*, std::shared_ptr<const ValueRange>);
 
     bool filter(const MarsRequest& filter);
     bool matches(const MarsRequest& filter) const;
@@ -136,15 +156,17 @@ public:  // static methods
 private:  // members
 
     std::string verb_;
-    std::list<Parameter> params_;
+    /// Parameters in insertion order, looked up by their interned keyword id (see Keyword). Requests have a few tens
+    /// of parameters at most, so that scanning the contiguous ids beats any hashing
+    Parameters params_;
 
 private:  // methods
 
     void print(std::ostream&) const;
     void encode(eckit::Stream&) const;
 
-    std::list<Parameter>::const_iterator find(const std::string&) const;
-    std::list<Parameter>::iterator find(const std::string&);
+    Parameters::const_iterator find(const std::string&) const;
+    Parameters::iterator find(const std::string&);
 
     // -- Class members
 
@@ -184,6 +206,36 @@ size_t MarsRequest::getValues(const std::string& name, std::vector<T>& v, bool e
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+
+class MarsRequest::Merger {
+public:
+
+    explicit Merger(const MarsRequest& first);
+
+    void add(const MarsRequest& other);
+
+    /// The request is only handed out read-only, as values added behind the back of the merger would be duplicated
+    /// by the next add(). A merger that is done with can give its request away
+    const MarsRequest& request() const& { return request_; }
+    MarsRequest request() && { return std::move(request_); }
+
+private:
+
+    MarsRequest request_;
+    std::vector<std::unordered_set<std::string>> seen_;  // values of each parameter of request_
+};
+
+template <class Iterator>
+MarsRequest MarsRequest::merge(Iterator begin, Iterator end) {
+    ASSERT(begin != end);
+    Merger merger(*begin);
+    for (++begin; begin != end; ++begin) {
+        merger.add(*begin);
+    }
+    return std::move(merger).request();
+}
+
 template <class T>
 void MarsRequest::setValue(const std::string& name, const T& value) {
     eckit::Translator<T, std::string> t;
@@ -63,6 +63,9 @@ public:
     bool match(const RequestLike& request, MatchMissingPolicy matchOnMissing = MatchOnMissing) const;
     bool match(const MarsRequest& request, MatchMissingPolicy matchOnMissing = MatchOnMissing) const;
 
+    const std::map<std::string, eckit::Regex>& regexMap() const { return regexMap_; }
+    Policy policy() const { return policy_; }
+
     void print(std::ostream& s) const;
 
     friend std::ostream& operator<<(std::ostream& s, const Matcher& m) {
@@ -0,0 +1,376 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MatcherSet.cc
+/// @date   Oct 2026
+
+#include "metkit/mars/MatcherSet.h"
+
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <ostream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/utils/Overloaded.h"
+#include "eckit/utils/Regex.h"
+
+namespace metkit::mars {
+
+namespace {
+
+class MarsRequestAccessor : public RequestLike {
+public:
+
+    explicit MarsRequestAccessor(const MarsRequest& request) : request_(request) {}
+
+    std::optional<values_t> get(const std::string& keyword) const override { return request_.get(keyword); }
+
+private:
+
+    const MarsRequest& request_;
+};
+
+/// A pattern that needs no regular expression engine: alternatives of plain characters sharing the same anchors,
+/// e.g. "enfo", "^(od|rd)$", "^0001" or "a|b"
+struct Literal {
+    std::vector<std::string> alternatives;
+    bool front = false;  // '^'
+    bool back  = false;  // '$'
+
+    bool exact() const { return front && back; }
+
+    bool match(const std::string& value) const {
+        for (const auto& a : alternatives) {
+            if (a.size() > value.size()) {
+                continue;
+            }
+            if (front) {
+                if (value.compare(0, a.size(), a) == 0) {
+                    return true;
+                }
+            }
+            else if (back) {
+                if (value.compare(value.size() - a.size(), a.size(), a) == 0) {
+                    return true;
+                }
+            }
+            else if (value.find(a) != std::string::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+bool special(char c) {
+    return std::strchr(".[]()*+?{}|^$\\", c) != nullptr;
+}
+
+std::optional<Literal> literal(const std::string& pattern) {
+    Literal l;
+
+    size_t begin = 0;
+    size_t end   = pattern.size();
+
+    if (begin < end && pattern[begin] == '^') {
+        l.front = true;
+        begin++;
+    }
+    if (begin < end && pattern[end - 1] == '$' && (end - begin < 2 || pattern[end - 2] != '\\')) {
+        l.back = true;
+        end--;
+    }
+
+    bool group = false;
+    if (end - begin >= 2 && pattern[begin] == '(' && pattern[end - 1] == ')') {
+        group = true;
+        begin++;
+        end--;
+    }
+
+    std::string current;
+    for (size_t i = begin; i < end; ++i) {
+        char c = pattern[i];
+        if (c == '\\') {
+            if (i + 1 == end || !special(pattern[i + 1])) {
+                return std::nullopt;
+            }
+            current += pattern[++i];
+        }
+        else if (c == '|') {
+            // "^a|b$" means "(^a)|(b$)", only split alternatives that share the anchors
+            if (!group && (l.front || l.back)) {
+                return std::nullopt;
+            }
+            l.alternatives.push_back(std::move(current));
+            current.clear();
+        }
+        else if (special(c)) {
+            return std::nullopt;
+        }
+        else {
+            current += c;
+        }
+    }
+    l.alternatives.push_back(std::move(current));
+
+    for (const auto& a : l.alternatives) {
+        if (a.empty()) {
+            return std::nullopt;
+        }
+    }
+
+    return l;
+}
+
+bool backReference(const std::string& pattern) {
+    for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+        if (pattern[i] == '\\') {
+            if (std::isdigit(static_cast<unsigned char>(pattern[i + 1]))) {
+                return true;
+            }
+            ++i;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MatcherSet::Result::Result(size_t size, bool value) :
+    size_(size), words_((size + 63) / 64, value ? ~uint64_t(0) : uint64_t(0)) {
+    if (value && size % 64) {
+        words_.back() = (uint64_t(1) << (size % 64)) - 1;
+    }
+}
+
+size_t MatcherSet::Result::count() const {
+    size_t n = 0;
+    for (uint64_t w : words_) {
+        n += __builtin_popcountll(w);
+    }
+    return n;
+}
+
+bool MatcherSet::Result::any() const {
+    for (uint64_t w : words_) {
+        if (w) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<size_t> MatcherSet::Result::indices() const {
+    std::vector<size_t> out;
+    for (size_t i = 0; i < words_.size(); ++i) {
+        for (uint64_t w = words_[i]; w; w &= w - 1) {
+            out.push_back(i * 64 + __builtin_ctzll(w));
+        }
+    }
+    return out;
+}
+
+MatcherSet::Result& MatcherSet::Result::operator|=(const Result& other) {
+    ASSERT(size_ == other.size_);
+    for (size_t i = 0; i < words_.size(); ++i) {
+        words_[i] |= other.words_[i];
+    }
+    return *this;
+}
+
+MatcherSet::Result& MatcherSet::Result::operator&=(const Result& other) {
+    ASSERT(size_ == other.size_);
+    for (size_t i = 0; i < words_.size(); ++i) {
+        words_[i] &= other.words_[i];
+    }
+    return *this;
+}
+
+void MatcherSet::Result::restrict(const Result& mask, const Result& keep) {
+    ASSERT(size_ == mask.size_ && size_ == keep.size_);
+    for (size_t i = 0; i < words_.size(); ++i) {
+        words_[i] &= ~(mask.words_[i] & ~keep.words_[i]);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Conditions of all the rules on one keyword
+struct MatcherSet::KeywordIndex {
+
+    struct LiteralRules {
+        Literal literal;
+        Result rules;
+    };
+
+    struct RegexRules {
+        eckit::Regex regex;
+        Result rules;
+    };
+
+    KeywordIndex(const std::string& keyword, size_t size) : keyword(keyword), rules(size) {}
+
+    /// Rules whose condition on the keyword matches value
+    Result matching(const std::string& value) const {
+        Result out(rules.size());
+
+        if (auto it = exact.find(value); it != exact.end()) {
+            out |= it->second;
+        }
+
+        for (const auto& l : literals) {
+            if (l.literal.match(value)) {
+                out |= l.rules;
+            }
+        }
+
+        if (!regexes.empty() && (!prefilter || prefilter->match(value))) {
+            for (const auto& r : regexes) {
+                if (r.regex.match(value)) {
+                    out |= r.rules;
+                }
+            }
+        }
+
+        return out;
+    }
+
+    std::string keyword;
+    Result rules;  // rules with a condition on the keyword
+
+    std::unordered_map<std::string, Result> exact;
+    std::vector<LiteralRules> literals;
+    std::vector<RegexRules> regexes;
+    std::unique_ptr<eckit::Regex> prefilter;  // matches if any of regexes does
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MatcherSet::MatcherSet(std::vector<Matcher> rules) : rules_(std::move(rules)), allPolicy_(rules_.size()) {
+
+    const size_t n = rules_.size();
+
+    // keyword -> pattern -> rules, so that a pattern shared by several rules is evaluated once
+    std::map<std::string, std::map<std::string, Result>> conditions;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (rules_[i].policy() == Matcher::Policy::All) {
+            allPolicy_.set(i);
+        }
+        for (const auto& [keyword, regex] : rules_[i].regexMap()) {
+            const std::string& pattern = regex;
+            auto& patterns             = conditions[keyword];
+            patterns.try_emplace(pattern, n).first->second.set(i);
+        }
+    }
+
+    for (const auto& [keyword, patterns] : conditions) {
+        auto index = std::make_unique<KeywordIndex>(keyword, n);
+
+        std::string combined;
+        bool combinable = true;
+
+        for (const auto& [pattern, rules] : patterns) {
+            index->rules |= rules;
+
+            if (auto l = literal(pattern)) {
+                if (l->exact()) {
+                    for (const auto& a : l->alternatives) {
+                        index->exact.try_emplace(a, n).first->second |= rules;
+                    }
+                }
+                else {
+                    index->literals.push_back({std::move(*l), rules});
+                }
+                continue;
+            }
+
+            index->regexes.push_back({eckit::Regex(pattern), rules});
+            combined += (combined.empty() ? "(" : "|(") + pattern + ")";
+            combinable = combinable && !backReference(pattern);
+        }
+
+        if (index->regexes.size() > 1 && combinable) {
+            index->prefilter = std::make_unique<eckit::Regex>(combined);
+        }
+
+        keywords_.push_back(std::move(index));
+    }
+}
+
+MatcherSet::~MatcherSet() = default;
+
+MatcherSet::Result MatcherSet::match(const MarsRequest& request, Matcher::MatchMissingPolicy matchOnMissing) const {
+    return match(MarsRequestAccessor(request), matchOnMissing);
+}
+
+MatcherSet::Result MatcherSet::match(const RequestLike& request, Matcher::MatchMissingPolicy matchOnMissing) const {
+    Result result(rules_.size(), true);
+
+    for (const auto& index : keywords_) {
+        auto values = request.get(index->keyword);
+
+        if (!values) {
+            if (matchOnMissing == Matcher::DontMatchOnMissing) {
+                result.restrict(index->rules, Result(rules_.size()));
+            }
+            continue;
+        }
+
+        // clang-format off
+        Result passed = std::visit(eckit::Overloaded {
+            [&](std::reference_wrapper<const std::string> value) {
+                return index->matching(value.get());
+            },
+            [&](std::reference_wrapper<const std::vector<std::string>> values) {
+                Result any(rules_.size());
+                Result all(index->rules);
+                for (const auto& v : values.get()) {
+                    Result m = index->matching(v);
+                    any |= m;
+                    all &= m;
+                }
+                // Policy::Any rules need one matching value, Policy::All rules need all of them
+                all &= allPolicy_;
+                any.restrict(allPolicy_, Result(rules_.size()));
+                any |= all;
+                return any;
+            }
+        }, *values);
+        // clang-format on
+
+        result.restrict(index->rules, passed);
+
+        if (result.none()) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+void MatcherSet::print(std::ostream& s) const {
+    s << "MatcherSet[";
+    const char* sep = "";
+    for (const auto& m : rules_) {
+        s << sep << m;
+        sep = ",";
+    }
+    s << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -0,0 +1,112 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MatcherSet.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "metkit/mars/Matcher.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Many Matcher rules compiled together, e.g. a routing table
+///
+/// Conditions are indexed by keyword, so each keyword of the request is looked up once for all the rules. Exact
+/// literals (e.g. "^enfo$" or "^(od|rd)$") are found with a hash lookup, other literals (e.g. "0001") with a substring
+/// search, and the remaining regular expressions are evaluated once per distinct pattern, behind a single combined
+/// expression that rejects the values none of them matches.
+///
+/// The result of match(r) is the set of rules i for which rule(i).match(r) is true.
+class MatcherSet {
+public:  // types
+
+    /// Set of rules, by index
+    class Result {
+    public:
+
+        explicit Result(size_t size = 0, bool value = false);
+
+        size_t size() const { return size_; }
+        bool test(size_t i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+        bool operator[](size_t i) const { return test(i); }
+
+        void set(size_t i) { words_[i / 64] |= uint64_t(1) << (i % 64); }
+
+        size_t count() const;
+        bool any() const;
+        bool none() const { return !any(); }
+
+        /// Index of the matching rules, in increasing order
+        std::vector<size_t> indices() const;
+
+        Result& operator|=(const Result& other);
+        Result& operator&=(const Result& other);
+
+        /// Clears the rules of mask that are not in keep
+        void restrict(const Result& mask, const Result& keep);
+
+        bool operator==(const Result& other) const { return size_ == other.size_ && words_ == other.words_; }
+        bool operator!=(const Result& other) const { return !(*this == other); }
+
+    private:
+
+        size_t size_;
+        std::vector<uint64_t> words_;
+    };
+
+public:  // methods
+
+    explicit MatcherSet(std::vector<Matcher> rules);
+
+    ~MatcherSet();
+
+    MatcherSet(const MatcherSet&)            = delete;
+    MatcherSet& operator=(const MatcherSet&) = delete;
+
+    size_t size() const { return rules_.size(); }
+    const Matcher& rule(size_t i) const { return rules_.at(i); }
+
+    Result match(const RequestLike& request,
+                 Matcher::MatchMissingPolicy matchOnMissing = Matcher::MatchOnMissing) const;
+    Result match(const MarsRequest& request,
+                 Matcher::MatchMissingPolicy matchOnMissing = Matcher::MatchOnMissing) const;
+
+    void print(std::ostream& s) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const MatcherSet& m) {
+        m.print(s);
+        return s;
+    }
+
+private:  // types
+
+    struct KeywordIndex;
+
+private:  // members
+
+    std::vector<Matcher> rules_;
+    Result allPolicy_;  // rules with Policy::All
+
+    std::vector<std::unique_ptr<KeywordIndex>> keywords_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
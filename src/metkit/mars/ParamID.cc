@@ -95,6 +95,23 @@ NormalisationMode ParamID::normalisationMode() {
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+
+void ParamID::AxisIndex::index() {
+    for (const auto& [paramid, p] : paramIds_) {
+        auto [j, inserted] = dropped_.try_emplace(paramid % 1000, paramid, p);
+        if (!inserted && paramid < j->second.first) {
+            j->second = {paramid, p};
+        }
+    }
+
+    for (const auto& wf : getWindFamilies()) {
+        if (contains(wf.vo_) && contains(wf.d_)) {
+            windFamilies_.push_back(&wf);
+        }
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace metkit
@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "eckit/config/Resource.h"
@@ -57,12 +59,61 @@ public:  // types
             u_(u), v_(v), vo_(vo), d_(d) {}
     };
 
+    /// Hashed index of the params of an axis, built once and reused across calls to normalise()
+    class AxisIndex {
+    public:
+
+        template <typename AXIS_T>
+        explicit AxisIndex(const AXIS_T& axis) {
+            for (typename AXIS_T::const_iterator j = axis.begin(); j != axis.end(); ++j) {
+                Param p = *j;
+                params_.emplace(p);
+                paramIds_[p.paramId()] = p;
+            }
+            index();
+        }
+
+        bool contains(const Param& p) const { return params_.find(p) != params_.end(); }
+
+        /// The param of the axis with this paramId, or nullptr
+        const Param* find(long paramid) const {
+            auto j = paramIds_.find(paramid);
+            return j == paramIds_.end() ? nullptr : &j->second;
+        }
+
+        /// The param of the axis with the smallest paramId equal to paramid modulo 1000, or nullptr
+        const Param* findDroppingTable(long paramid) const {
+            auto j = dropped_.find(paramid % 1000);
+            return j == dropped_.end() ? nullptr : &j->second.second;
+        }
+
+        /// The wind families whose vorticity and divergence are in the axis
+        const std::vector<const WindFamily*>& windFamilies() const { return windFamilies_; }
+
+    private:
+
+        void index();
+
+        struct Hash {
+            size_t operator()(const Param& p) const { return std::hash<long>{}(p.value()) * 31 + p.table(); }
+        };
+
+        std::unordered_set<Param, Hash> params_;
+        std::unordered_map<long, Param> paramIds_;
+        std::unordered_map<long, std::pair<long, Param>> dropped_;  // paramId % 1000 -> (paramId, param)
+        std::vector<const WindFamily*> windFamilies_;
+    };
+
 public:  // methods
 
     template <typename REQUEST_T, typename AXIS_T>
     static void normalise(const REQUEST_T& r, std::vector<Param>& req, const AXIS_T& axis, bool& windConversion,
                           NormalisationMode mode = ParamID::normalisationMode());
 
+    template <typename REQUEST_T>
+    static void normalise(const REQUEST_T& r, std::vector<Param>& req, const AxisIndex& axis, bool& windConversion,
+                          NormalisationMode mode = ParamID::normalisationMode());
+
     template <typename REQUEST_T, typename AXIS_T>
     [[deprecated]] static void normalise(const REQUEST_T& r, std::vector<Param>& req, const AXIS_T& axis,
                                          bool& windConversion, bool fullTableDropping, bool forceGRIBParamID = false);
@@ -94,53 +145,47 @@ void ParamID::normalise(const REQUEST_T& request, std::vector<Param>& req, const
 template <typename REQUEST_T, typename AXIS_T>
 void ParamID::normalise(const REQUEST_T& request, std::vector<Param>& req, const AXIS_T& axis, bool& windConversion,
                         NormalisationMode mode) {
+    normalise(request, req, AxisIndex(axis), windConversion, mode);
+}
+
+template <typename REQUEST_T>
+void ParamID::normalise(const REQUEST_T& request, std::vector<Param>& req, const AxisIndex& axis,
+                        bool& windConversion, NormalisationMode mode) {
 
     static const bool useGRIBParamID = eckit::Resource<bool>("useGRIBParamID", false);
     bool strict                      = useGRIBParamID || mode == NormalisationMode::Strict;
 
-    const std::vector<WindFamily>& windFamilies(getWindFamilies());
-
     std::vector<std::pair<Param, Param>> tableDropped;
-    std::set<Param> inAxis;
-    std::map<long, Param> inAxisParamID;
     std::set<Param> wind;
 
-
-    for (typename AXIS_T::const_iterator j = axis.begin(); j != axis.end(); ++j) {
-        Param p = *j;
-        inAxis.emplace(p);
-        inAxisParamID[p.paramId()] = p;
-    }
-
     std::vector<Param> newreq;
     newreq.reserve(req.size());
 
     for (const auto& r : req) {
-        if (inAxis.find(r) != inAxis.end()) {  // Perfect match - look no further
+        if (axis.contains(r)) {  // Perfect match - look no further
             newreq.push_back(r);
         }
         else {  // r is normalised to ParamID
-            long paramid   = r.paramId();
-            const auto& ap = inAxisParamID.find(paramid);
+            long paramid    = r.paramId();
+            const Param* ap = axis.find(paramid);
 
             // ParamID representation matching - look no further
-            if (ap != inAxisParamID.end()) {
-                newreq.push_back(ap->second);
+            if (ap) {
+                newreq.push_back(*ap);
             }
             else {  // Special case for U/V - exact match
                 bool ok = false;
-                for (const auto& wf : windFamilies) {
-                    if ((paramid == wf.u_.paramId() || paramid == wf.v_.paramId() ||
-                         (!strict && (paramid == wf.u_.grib1value() || paramid == wf.v_.grib1value()))) &&
-                        inAxis.find(wf.vo_) != inAxis.end() && inAxis.find(wf.d_) != inAxis.end()) {
+                for (const WindFamily* wf : axis.windFamilies()) {
+                    if (paramid == wf->u_.paramId() || paramid == wf->v_.paramId() ||
+                        (!strict && (paramid == wf->u_.grib1value() || paramid == wf->v_.grib1value()))) {
 
-                        if (paramid == wf.u_.paramId() || (!strict && paramid == wf.u_.grib1value()))
-                            newreq.push_back(wf.u_);
+                        if (paramid == wf->u_.paramId() || (!strict && paramid == wf->u_.grib1value()))
+                            newreq.push_back(wf->u_);
                         else
-                            newreq.push_back(wf.v_);
+                            newreq.push_back(wf->v_);
 
-                        wind.emplace(wf.vo_);
-                        wind.emplace(wf.d_);
+                        wind.emplace(wf->vo_);
+                        wind.emplace(wf->d_);
                         windConversion = true;
 
                         ok = true;
@@ -151,23 +196,23 @@ void ParamID::normalise(const REQUEST_T& request, std::vector<Param>& req, const
                 if (!ok && !strict && r.table() == 0 && paramid < 1000) {
                     const std::vector<size_t>& dropTables = ParamID::getDropTables();
                     for (auto t : dropTables) {
-                        auto ap = inAxisParamID.find(replaceTable(t, paramid));
-                        if (ap != inAxisParamID.end()) {  // ParamID representation matching - look no further
-                            newreq.push_back(ap->second);
+                        if (const Param* ap = axis.find(replaceTable(t, paramid))) {
+                            // ParamID representation matching - look no further
+                            newreq.push_back(*ap);
                             ok = true;
                             break;
                         }
                     }
 
                     if (!ok) {  // Special case for U/V - partial match
-                        for (const auto& wf : windFamilies) {
+                        for (const auto& wf : getWindFamilies()) {
                             if (paramid == wf.u_.paramId() || paramid == wf.v_.paramId()) {
                                 for (auto t : dropTables) {
-                                    auto vo = inAxisParamID.find(replaceTable(t, wf.vo_.paramId()));
-                                    auto d  = inAxisParamID.find(replaceTable(t, wf.d_.paramId()));
+                                    const Param* vo = axis.find(replaceTable(t, wf.vo_.paramId()));
+                                    const Param* d  = axis.find(replaceTable(t, wf.d_.paramId()));
 
-                                    if (vo != inAxisParamID.end() && d != inAxisParamID.end()) {
-                                        bool grib1 = vo->second.table() > 0;
+                                    if (vo && d) {
+                                        bool grib1 = vo->table() > 0;
                                         if (paramid == wf.u_.paramId())
                                             newreq.push_back(grib1 ? Param(t, paramid)
                                                                    : Param(0, replaceTable(t, paramid)));
@@ -175,8 +220,8 @@ void ParamID::normalise(const REQUEST_T& request, std::vector<Param>& req, const
                                             newreq.push_back(grib1 ? Param(t, paramid)
                                                                    : Param(0, replaceTable(t, paramid)));
 
-                                        wind.emplace(vo->second);
-                                        wind.emplace(d->second);
+                                        wind.emplace(*vo);
+                                        wind.emplace(*d);
                                         windConversion = true;
 
                                         ok = true;
@@ -190,13 +235,10 @@ void ParamID::normalise(const REQUEST_T& request, std::vector<Param>& req, const
                     }
                     if (mode == NormalisationMode::FullTableDropping && !ok) {
                         // Backward compatibility - Partial match (drop completely table information)
-                        for (const auto& ap : inAxisParamID) {
-                            if (ap.first % 1000 == paramid % 1000) {
-                                newreq.push_back(ap.second);
-                                ok = true;
-                                tableDropped.push_back(std::make_pair(r, ap.second));
-                                break;
-                            }
+                        if (const Param* ap = axis.findDroppingTable(paramid)) {
+                            newreq.push_back(*ap);
+                            ok = true;
+                            tableDropped.push_back(std::make_pair(r, *ap));
                         }
                     }
                 }
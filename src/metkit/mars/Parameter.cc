@@ -9,7 +9,10 @@
  */
 
 #include <algorithm>
-#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
 
 #include "metkit/mars/Parameter.h"
 #include "metkit/mars/Type.h"
@@ -37,72 +40,225 @@ static UndefinedType undefined;
 //----------------------------------------------------------------------------------------------------------------------
 
 
-Parameter::Parameter() : type_(&undefined) {
+static const std::shared_ptr<std::vector<std::string>>& noValues() {
+    static const auto* empty = new std::shared_ptr<std::vector<std::string>>(new std::vector<std::string>());
+    return *empty;
+}
+
+/// Guards the binary form of the values of the parameters, set on first use from const methods. The mutexes are shared
+/// by address, so that parameters stay small and copyable
+static std::mutex& typedMutex(const void* parameter) {
+    static std::mutex mutexes[64];
+    return mutexes[(reinterpret_cast<std::uintptr_t>(parameter) / alignof(std::max_align_t)) % 64];
+}
+
+/// Marks the values that have no binary form
+static const std::shared_ptr<const std::vector<TypedValue>>& noTyped() {
+    static const auto* none = new std::shared_ptr<const std::vector<TypedValue>>(new std::vector<TypedValue>());
+    return *none;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Parameter::Parameter() : type_(&undefined), keyword_(type_->keyId()), values_(noValues()) {
     type_->attach();
 }
 
 Parameter::~Parameter() {
-    type_->detach();
+    if (type_) {
+        type_->detach();
+    }
 }
 
-Parameter::Parameter(const std::vector<std::string>& values, Type* type) : type_(type), values_(values) {
-    if (!type) {
-        type_ = &undefined;
-    }
+Parameter::Parameter(const std::vector<std::string>& values, const Type* type) :
+    type_(type ? type : &undefined),
+    keyword_(type_->keyId()),
+    values_(values.empty() ? noValues() : std::make_shared<std::vector<std::string>>(values)) {
     type_->attach();
 }
 
 
-Parameter::Parameter(const Parameter& other) : type_(other.type_), values_(other.values_) {
+Parameter::Parameter(std::shared_ptr<const ValueRange> range, const Type* type) :
+    type_(type ? type : &undefined), keyword_(type_->keyId()), values_(noValues()), range_(std::move(range)) {
+    ASSERT(range_);
+    type_->attach();
+}
+
+Parameter::Parameter(const Parameter& other) :
+    type_(other.type_),
+    keyword_(other.keyword_),
+    values_(other.values_),
+    range_(other.range_) {
+    {
+        std::lock_guard<std::mutex> lock(typedMutex(&other));
+        typed_ = other.typed_;
+    }
     type_->attach();
 }
 
+Parameter::Parameter(Parameter&& other) noexcept :
+    type_(other.type_),
+    keyword_(other.keyword_),
+    values_(std::move(other.values_)),
+    range_(std::move(other.range_)),
+    typed_(std::move(other.typed_)) {
+    // left without values, as by the default constructor
+    other.type_    = &undefined;
+    other.keyword_ = undefined.keyId();
+    other.values_  = noValues();
+    other.type_->attach();
+}
+
 Parameter& Parameter::operator=(const Parameter& other) {
-    Type* old = type_;
-    type_     = other.type_;
+    const Type* old = type_;
+    type_           = other.type_;
     type_->attach();
-    old->detach();
+    if (old) {
+        old->detach();
+    }
+
+    keyword_ = other.keyword_;
+    values_  = other.values_;
+    range_   = other.range_;
+
+    std::shared_ptr<const std::vector<TypedValue>> typed;
+    {
+        std::lock_guard<std::mutex> lock(typedMutex(&other));
+        typed = other.typed_;
+    }
+    typed_ = std::move(typed);
+    return *this;
+}
 
-    values_ = other.values_;
+Parameter& Parameter::operator=(Parameter&& other) noexcept {
+    std::swap(type_, other.type_);
+    std::swap(keyword_, other.keyword_);
+    std::swap(values_, other.values_);
+    std::swap(range_, other.range_);
+    std::swap(typed_, other.typed_);
     return *this;
 }
 
+std::vector<std::string>& Parameter::mutableValues() {
+    typed_.reset();
+    if (range_) {
+        values_ = std::make_shared<std::vector<std::string>>(range_->values());
+        range_.reset();
+    }
+    else if (values_.use_count() > 1) {
+        values_ = std::make_shared<std::vector<std::string>>(*values_);
+    }
+    return *values_;
+}
+
 void Parameter::values(const std::vector<std::string>& values) {
-    values_ = values;
+    values_ = values.empty() ? noValues() : std::make_shared<std::vector<std::string>>(values);
+    range_.reset();
+    typed_.reset();
+}
+
+const std::vector<TypedValue>* Parameter::typed() const {
+    std::shared_ptr<const std::vector<TypedValue>> typed;
+    {
+        std::lock_guard<std::mutex> lock(typedMutex(this));
+        typed = typed_;
+    }
+
+    if (!typed) {
+        auto encoded = std::make_shared<std::vector<TypedValue>>();
+        encoded->reserve(size());
+        for (const auto& v : values()) {
+            TypedValue t = type_->encode(v);
+            if (!t) {
+                encoded = nullptr;
+                break;
+            }
+            encoded->push_back(t);
+        }
+
+        // Another thread may have encoded the values meanwhile, the first result is kept
+        std::lock_guard<std::mutex> lock(typedMutex(this));
+        if (!typed_) {
+            typed_ = encoded ? encoded : noTyped();
+        }
+        typed = typed_;
+    }
+
+    return typed == noTyped() ? nullptr : typed.get();
 }
 
 bool Parameter::filter(const std::vector<std::string>& filter) {
-    return type_->filter(filter, values_);
+    return type_->filter(filter, mutableValues());
 }
 
 bool Parameter::filter(const std::string& keyword, const std::vector<std::string>& filter) {
-    return type_->filter(keyword, filter, values_);
+    return type_->filter(keyword, filter, mutableValues());
 }
 
 
 bool Parameter::matches(const std::vector<std::string>& match) const {
-    return type_->matches(match, values_);
+    return type_->matches(match, values());
+}
+
+bool Parameter::filter(const Parameter& f) {
+    const std::vector<TypedValue>* allowed = f.type_ == type_ ? f.typed() : nullptr;
+    const std::vector<TypedValue>* typed   = allowed ? this->typed() : nullptr;
+    if (!typed) {
+        return filter(f.values());
+    }
+
+    const std::unordered_set<TypedValue> set(allowed->begin(), allowed->end());
+
+    std::vector<std::string> values;
+    auto kept = std::make_shared<std::vector<TypedValue>>();
+    for (size_t i = 0; i < typed->size(); ++i) {
+        if (set.find((*typed)[i]) != set.end()) {
+            values.push_back(this->values()[i]);
+            kept->push_back((*typed)[i]);
+        }
+    }
+
+    if (values.size() != typed->size()) {
+        this->values(values);
+        typed_ = std::move(kept);
+    }
+    return !values.empty();
+}
+
+bool Parameter::matches(const Parameter& match) const {
+    const std::vector<TypedValue>* wanted = match.type_ == type_ ? match.typed() : nullptr;
+    const std::vector<TypedValue>* typed  = wanted ? this->typed() : nullptr;
+    if (!typed) {
+        return matches(match.values());
+    }
+
+    const std::unordered_set<TypedValue> set(wanted->begin(), wanted->end());
+    for (const auto& v : *typed) {
+        if (set.find(v) != set.end()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void Parameter::merge(const Parameter& p) {
-    ASSERT(name() == p.name());
+    std::unordered_set<std::string> seen(values().begin(), values().end());
+    merge(p, seen);
+}
 
-    /// @note this isn't optimal O(N^2) but it respects the order
+void Parameter::merge(const Parameter& p, std::unordered_set<std::string>& seen) {
+    ASSERT(keyword_ == p.keyword_);
 
-    std::vector<std::string> diff;
-    for (auto& o : p.values_) {
-        bool found = false;
-        for (auto& v : values_) {
-            if (v == o) {
-                found = true;
-                break;
+    // The order of the values is kept, new values are appended in the order of p
+    std::vector<std::string>* values = nullptr;
+    for (const auto& v : p.values()) {
+        if (seen.insert(v).second) {
+            if (!values) {
+                values = &mutableValues();
             }
+            values->push_back(v);
         }
-        if (!found)
-            diff.push_back(o);
     }
-
-    values_.insert(values_.end(), std::make_move_iterator(diff.begin()), std::make_move_iterator(diff.end()));
 }
 
 
@@ -111,18 +267,21 @@ const std::string& Parameter::name() const {
 }
 
 size_t Parameter::count() const {
-    return type_->count(values_);
+    if (range_) {
+        return type_->flatten() ? range_->size() : 1;
+    }
+    return type_->count(*values_);
 }
 
 void Parameter::print(std::ostream& s) const {
-    s << "Parameter[type=" << *type_ << ",values=" << values_ << "]";
+    s << "Parameter[type=" << *type_ << ",values=" << values() << "]";
 }
 
 bool Parameter::operator<(const Parameter& other) const {
     if (name() != other.name()) {
         return name() < other.name();
     }
-    return values_ < other.values_;
+    return values() < other.values();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -17,12 +17,19 @@
 #ifndef metkit_Parameter_H
 #define metkit_Parameter_H
 
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+
 #include "eckit/types/Date.h"
 #include "eckit/types/Double.h"
 #include "eckit/types/Time.h"
 #include "eckit/utils/Translator.h"
 #include "eckit/value/Value.h"
 
+#include "metkit/mars/TypedValue.h"
+#include "metkit/mars/ValueRange.h"
+
 namespace eckit {
 class JSON;
 class MD5;
@@ -43,30 +50,56 @@ public:  // methods
     Parameter();
     ~Parameter();
 
-    Parameter(const std::vector<std::string>& values, Type* = 0);
+    Parameter(const std::vector<std::string>& values, const Type* = 0);
+    Parameter(std::shared_ptr<const ValueRange> range, const Type*);
     Parameter(const Parameter&);
+    Parameter(Parameter&&) noexcept;
 
     Parameter& operator=(const Parameter&);
+    Parameter& operator=(Parameter&&) noexcept;
     bool operator<(const Parameter&) const;
 
-    const std::vector<std::string>& values() const { return values_; }
+    /// The values, a range is materialised on first use
+    const std::vector<std::string>& values() const { return range_ ? range_->values() : *values_; }
     void values(const std::vector<std::string>& values);
 
+    /// The values as an unexpanded range, nullptr if they are a plain list
+    const std::shared_ptr<const ValueRange>& range() const { return range_; }
+
+    /// Number of values, without materialising a range
+    size_t size() const { return range_ ? range_->size() : values_->size(); }
+
+    /// Binary form of the values (see Type::encode), built on first use. nullptr if any of the values has none
+    const std::vector<TypedValue>* typed() const;
+
     bool filter(const std::vector<std::string>& filter);
     bool filter(const std::string& keyword, const std::vector<std::string>& filter);
     bool matches(const std::vector<std::string>& matches) const;
 
+    /// Same as above, comparing the binary form of the values when both parameters are of the same type
+    bool filter(const Parameter& filter);
+    bool matches(const Parameter& matches) const;
+
     void merge(const Parameter& p);
 
-    Type& type() const { return *type_; }
+    /// Merges the values of p that are not in seen (the values of this parameter), and adds them to seen
+    void merge(const Parameter& p, std::unordered_set<std::string>& seen);
+
+    const Type& type() const { return *type_; }
     const std::string& name() const;
 
+    /// Interned id of the name, see Keyword
+    uint32_t keyword() const { return keyword_; }
+
     size_t count() const;
 
 private:  // methods
 
     void print(std::ostream&) const;
 
+    /// The values, copied first if they are shared with other parameters, or materialised if they are a range
+    std::vector<std::string>& mutableValues();
+
     friend std::ostream& operator<<(std::ostream& s, const Parameter& p) {
         p.print(s);
         return s;
@@ -74,8 +107,14 @@ private:  // methods
 
 private:  // members
 
-    Type* type_;
-    std::vector<std::string> values_;
+    const Type* type_;
+    uint32_t keyword_;
+    /// Copies of a parameter share their values until one of them is modified
+    std::shared_ptr<std::vector<std::string>> values_;
+    /// Set instead of values_ while the values are an unexpanded range
+    std::shared_ptr<const ValueRange> range_;
+    /// Binary form of the values, set on first use (under a lock, see typed())
+    mutable std::shared_ptr<const std::vector<TypedValue>> typed_;
 };
 
 
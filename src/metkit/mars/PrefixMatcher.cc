@@ -0,0 +1,226 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "metkit/mars/PrefixMatcher.h"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <set>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/types/Types.h"
+
+#include "metkit/config/LibMetkit.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+bool strictMode() {
+    static bool strict = eckit::Resource<bool>("$METKIT_LANGUAGE_STRICT_MODE", true);
+    return strict;
+}
+
+bool isnumeric(const std::string& s) {
+    for (size_t i = 0; i < s.length(); i++) {
+        if (!::isdigit(s[i])) {
+            return false;
+        }
+    }
+
+    return s.length() > 0;
+}
+
+inline unsigned char lower(char c) {
+    return static_cast<unsigned char>(::tolower(static_cast<unsigned char>(c)));
+}
+
+std::string lower(const std::string& s) {
+    std::string result(s);
+    for (auto& c : result) {
+        c = static_cast<char>(lower(c));
+    }
+    return result;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PrefixMatcher::PrefixMatcher() : nodes_(1) {}
+
+PrefixMatcher::PrefixMatcher(const std::vector<std::string>& values, const std::map<std::string, std::string>& aliases) :
+    values_(values), strict_(strictMode()) {
+
+    ASSERT(values_.size() < none);
+
+    resolved_.reserve(values_.size());
+    aliased_.reserve(values_.size());
+    for (const auto& v : values_) {
+        auto a = aliases.find(v);
+        aliased_.push_back(a != aliases.end());
+        resolved_.push_back(a != aliases.end() ? a->second : v);
+    }
+
+    std::vector<std::string> lowered;
+    lowered.reserve(values_.size());
+    for (const auto& v : values_) {
+        lowered.push_back(lower(v));
+    }
+
+    sorted_.resize(values_.size());
+    std::iota(sorted_.begin(), sorted_.end(), 0);
+    std::sort(sorted_.begin(), sorted_.end(), [&lowered](uint32_t a, uint32_t b) {
+        int c = lowered[a].compare(lowered[b]);
+        return c < 0 || (c == 0 && a < b);
+    });
+
+    // As the values are inserted in sorted order, the values below a node are contiguous in sorted_, and the children
+    // of a node are created in increasing order of their character
+
+    nodes_.emplace_back();
+    nodes_[0].end = static_cast<uint32_t>(sorted_.size());
+
+    for (uint32_t k = 0; k < sorted_.size(); ++k) {
+        const uint32_t i = sorted_[k];
+
+        uint32_t n = 0;
+        for (char c : lowered[i]) {
+            auto& children = nodes_[n].children;
+            if (children.empty() || children.back().first != c) {
+                children.emplace_back(c, static_cast<uint32_t>(nodes_.size()));
+                nodes_.emplace_back();
+                nodes_.back().begin = k;
+            }
+            n = nodes_[n].children.back().second;
+            nodes_[n].end = k + 1;
+        }
+
+        if (nodes_[n].exact == none) {
+            nodes_[n].exact = i;
+        }
+    }
+}
+
+uint32_t PrefixMatcher::walk(const std::string& name, size_t& depth) const {
+    uint32_t n = 0;
+    depth      = 0;
+
+    for (char c : name) {
+        const auto& children = nodes_[n].children;
+        const unsigned char l = lower(c);
+
+        auto j = std::lower_bound(children.begin(), children.end(), l,
+                                  [](const std::pair<char, uint32_t>& child, unsigned char x) {
+                                      return static_cast<unsigned char>(child.first) < x;
+                                  });
+        if (j == children.end() || static_cast<unsigned char>(j->first) != l) {
+            break;
+        }
+        n = j->second;
+        ++depth;
+    }
+
+    return n;
+}
+
+const std::string* PrefixMatcher::exact(const std::string& name) const {
+    size_t depth;
+    const Node& node = nodes_[walk(name, depth)];
+    if (depth == name.length() && node.exact != none) {
+        return &resolved_[node.exact];
+    }
+    return nullptr;
+}
+
+std::string PrefixMatcher::match(const std::string& name, bool fail, bool quiet, bool fullMatch) const {
+    size_t depth;
+    const Node& node = nodes_[walk(name, depth)];
+
+    if (depth == name.length() && node.exact != none) {
+        return resolved_[node.exact];
+    }
+
+    // The values below the deepest node reached are the ones sharing the longest prefix with the name
+    size_t score = (fullMatch ? name.length() : 1);
+    std::vector<uint32_t> best;
+    if (depth >= score) {
+        best.assign(sorted_.begin() + node.begin, sorted_.begin() + node.end);
+        std::sort(best.begin(), best.end());
+    }
+
+    if (!quiet && !best.empty()) {
+        LOG_DEBUG_LIB(LibMetkit) << "Matching '" << name << "' with " << best.size() << " values" << std::endl;
+    }
+
+    if (best.size() == 1) {
+        const std::string& value = values_[best[0]];
+        // If the best entry is a number or not name
+        if (isnumeric(value) && (value != name)) {
+            best.clear();
+        }
+        else {
+            if (strict_ && value != name) {
+                std::ostringstream oss;
+                oss << "Cannot match [" << name << "] in " << values_;
+                throw eckit::UserError(oss.str());
+            }
+            return resolved_[best[0]];
+        }
+    }
+
+    if (best.empty()) {
+        if (!fail) {
+            return {};
+        }
+
+        std::ostringstream oss;
+        oss << "Cannot match [" << name << "] in " << values_;
+        throw eckit::UserError(oss.str());
+    }
+
+    // Several matches are only ambiguous if they are not aliases of the same value
+    std::set<std::string> names;
+    for (uint32_t b : best) {
+        names.insert(resolved_[b]);
+    }
+
+    if (names.size() == 1) {
+        return resolved_[best[0]];
+    }
+
+    if (!fail) {
+        return {};
+    }
+
+    std::ostringstream oss;
+    oss << "Ambiguous value '" << name << "' could be";
+
+    for (uint32_t b : best) {
+        if (aliased_[b]) {
+            oss << " '" << values_[b] << "' (" << resolved_[b] << ")";
+        }
+        else {
+            oss << " '" << values_[b] << "'";
+        }
+    }
+
+    throw eckit::UserError(oss.str());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -0,0 +1,75 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   PrefixMatcher.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Resolves names and abbreviations against a fixed set of values (keywords, parameter names, ...)
+///
+/// The values are compiled into a case-insensitive prefix trie, so that a name is matched in O(length of the name).
+/// The semantics are those of MarsLanguage::bestMatch(): an exact match (ignoring case) wins, otherwise the values
+/// sharing the longest prefix with the name are candidates. A single candidate is accepted (in strict mode only if it
+/// is the name itself), several candidates are ambiguous unless they are aliases of the same value.
+class PrefixMatcher {
+public:  // methods
+
+    PrefixMatcher();
+
+    PrefixMatcher(const std::vector<std::string>& values, const std::map<std::string, std::string>& aliases = {});
+
+    /// @param fail throw if there is no match, or if the match is ambiguous
+    /// @param quiet do not log the candidates
+    /// @param fullMatch only accept values starting with the whole name
+    /// @return the matched value (or the value it is an alias of), empty if there is no match and fail is false
+    std::string match(const std::string& name, bool fail, bool quiet, bool fullMatch) const;
+
+    /// Exact (case insensitive) match only, or nullptr
+    const std::string* exact(const std::string& name) const;
+
+    bool empty() const { return values_.empty(); }
+
+private:  // methods
+
+    /// Deepest node matching a prefix of the name, and the length of that prefix
+    uint32_t walk(const std::string& name, size_t& depth) const;
+
+private:  // members
+
+    static constexpr uint32_t none = UINT32_MAX;
+
+    struct Node {
+        std::vector<std::pair<char, uint32_t>> children;  // sorted by character
+        uint32_t begin = 0;                               // range of values (in sorted_) below this node
+        uint32_t end   = 0;
+        uint32_t exact = none;  // first value equal to the path to this node
+    };
+
+    std::vector<std::string> values_;
+    std::vector<std::string> resolved_;  // the values, or what they are an alias of
+    std::vector<bool> aliased_;
+    std::vector<uint32_t> sorted_;  // values sorted by lower case value, then by position
+    std::vector<Node> nodes_;
+    bool strict_ = true;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
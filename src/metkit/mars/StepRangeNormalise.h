@@ -15,6 +15,9 @@
 #define metkit_StepRangeNormalise_H
 
 #include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <vector>
 
 #include "eckit/exception/Exceptions.h"
 #include "metkit/mars/StepRange.h"
@@ -32,14 +35,48 @@ namespace mars {
 class StepRangeNormalise {
 public:
 
+    /// Hashed index of the steps of an axis, built once and reused across calls to normalise()
+    class AxisIndex {
+    public:
+
+        template <typename AXIS_T>
+        explicit AxisIndex(const AXIS_T& axis) {
+            for (const auto& s : axis) {
+                steps_.emplace(s);
+            }
+        }
+
+        /// The step of the axis equal to s, or nullptr
+        const StepRange* find(const StepRange& s) const {
+            auto j = steps_.find(s);
+            return j == steps_.end() ? nullptr : &*j;
+        }
+
+    private:
+
+        struct Hash {
+            size_t operator()(const StepRange& s) const {
+                return std::hash<double>{}(s.from()) * 31 + std::hash<double>{}(s.to());
+            }
+        };
+
+        std::unordered_set<StepRange, Hash> steps_;
+    };
+
     template <typename AXIS_T>
     static void normalise(std::vector<StepRange>& v, const AXIS_T& axis);
+
+    static void normalise(std::vector<StepRange>& v, const AxisIndex& axis);
 };
 
 //----------------------------------------------------------------------------------------------------------------------
 
 template <typename AXIS_T>
 void StepRangeNormalise::normalise(std::vector<StepRange>& values, const AXIS_T& axis) {
+    normalise(values, AxisIndex(axis));
+}
+
+inline void StepRangeNormalise::normalise(std::vector<StepRange>& values, const AxisIndex& axis) {
 
     std::vector<StepRange> outputValues;
 
@@ -47,8 +84,8 @@ void StepRangeNormalise::normalise(std::vector<StepRange>& values, const AXIS_T&
 
         // If the supplied range is found in the axis, then use that
 
-        auto j = std::find(axis.begin(), axis.end(), values[i]);
-        if (j != axis.end()) {
+        const StepRange* j = axis.find(values[i]);
+        if (j) {
             outputValues.push_back(values[i]);
 
             // If specified, and matched, a RANGE, then use that
@@ -62,8 +99,8 @@ void StepRangeNormalise::normalise(std::vector<StepRange>& values, const AXIS_T&
         double singleValue = values[i].from();
 
         if (values[i].from() != values[i].to()) {
-            j = std::find(axis.begin(), axis.end(), StepRange(singleValue, singleValue));
-            if (j != axis.end()) {
+            j = axis.find(StepRange(singleValue, singleValue));
+            if (j) {
                 outputValues.push_back(*j);
                 matched = true;
             }
@@ -72,8 +109,8 @@ void StepRangeNormalise::normalise(std::vector<StepRange>& values, const AXIS_T&
         // If singleValue == 0, this test is the same as the previous one...
 
         if (singleValue != 0) {
-            j = std::find(axis.begin(), axis.end(), StepRange(0, singleValue));
-            if (j != axis.end()) {
+            j = axis.find(StepRange(0, singleValue));
+            if (j) {
 
                 if (matched) {
                     eckit::Log::userWarning()
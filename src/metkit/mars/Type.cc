@@ -14,7 +14,9 @@
 #include <cstddef>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <set>
 #include <sstream>
@@ -26,6 +28,7 @@
 
 #include "metkit/hypercube/HyperCube.h"
 #include "metkit/mars/ContextRule.h"
+#include "metkit/mars/Keyword.h"
 #include "metkit/mars/MarsRequest.h"
 #include "metkit/mars/TypeToByList.h"
 
@@ -33,11 +36,44 @@ namespace metkit::mars {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+/// All the distinct rules of all the contexts. Only written while languages are built
+struct ContextRules {
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const ContextRule>> rules;
+};
+
+ContextRules& contextRules() {
+    static ContextRules* rules = new ContextRules();  // never deleted, types may outlive static destruction
+    return *rules;
+}
+
+}  // namespace
+
+size_t ContextRule::keyId(const std::string& key) {
+    return Keyword::id(key);
+}
+
 void Context::add(std::unique_ptr<ContextRule> rule) {
-    rules_.push_back(std::move(rule));
+    ASSERT(rule);
+
+    std::ostringstream oss;
+    oss << *rule;
+
+    ContextRules& registry = contextRules();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto it = registry.rules.find(oss.str());
+    if (it == registry.rules.end()) {
+        rule->id_    = registry.rules.size();
+        rule->keyId_ = Keyword::id(rule->key());
+        it           = registry.rules.emplace(oss.str(), std::move(rule)).first;
+    }
+    rules_.push_back(it->second);
 }
 
-bool Context::matches(MarsRequest req) const {
+bool Context::matches(const MarsRequest& req) const {
 
     for (const auto& r : rules_) {
         if (!r->matches(req)) {
@@ -47,6 +83,61 @@ bool Context::matches(MarsRequest req) const {
     return true;
 }
 
+bool Context::matches(const MarsRequest& req, ContextCache& cache) const {
+
+    for (const auto& r : rules_) {
+        if (!cache.matches(*r, req)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ContextCache::matches(const ContextRule& rule, const MarsRequest& request) {
+    const size_t word   = rule.id() / 64;
+    const uint64_t mask = uint64_t(1) << (rule.id() % 64);
+
+    if (word >= known_.size()) {
+        known_.resize(word + 1, 0);
+        results_.resize(word + 1, 0);
+    }
+
+    if (known_[word] & mask) {
+        return (results_[word] & mask) != 0;
+    }
+
+    const bool result = rule.matches(request);
+    known_[word] |= mask;
+    if (result) {
+        results_[word] |= mask;
+    }
+    else {
+        results_[word] &= ~mask;
+    }
+    evaluated_.emplace_back(rule.keyId(), rule.id());
+    return result;
+}
+
+void ContextCache::invalidate(size_t keyId) {
+    auto it = evaluated_.begin();
+    while (it != evaluated_.end()) {
+        if (it->first == keyId) {
+            known_[it->second / 64] &= ~(uint64_t(1) << (it->second % 64));
+            it = evaluated_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void ContextCache::clear() {
+    std::fill(known_.begin(), known_.end(), 0);
+    evaluated_.clear();
+}
+
 std::ostream& operator<<(std::ostream& s, const Context& c) {
     c.print(s);
     return s;
@@ -124,7 +215,7 @@ size_t Context::maxAxisIndex() const {
 //----------------------------------------------------------------------------------------------------------------------
 
 Type::Type(const std::string& name, const eckit::Value& settings) :
-    name_(name), flatten_(true), multiple_(false), duplicates_(true) {
+    name_(name), keyId_(ContextRule::keyId(name)), flatten_(true), multiple_(false), duplicates_(true) {
 
     if (settings.contains("multiple")) {
         multiple_ = settings["multiple"];
@@ -181,7 +272,7 @@ void Type::set(std::shared_ptr<Context> context, const std::vector<std::string>&
 void Type::unset(std::shared_ptr<Context> context) {
     unsets_.insert(std::move(context));
 }
-void Type::patchRequest(MarsRequest& request, const std::vector<std::string>& values) {
+void Type::patchRequest(MarsRequest& request, const std::vector<std::string>& values) const {
     // Special case: inheritance from another key.
     // If the value is of the form _key, then copy values from that key
     if (values.size() == 1 && values[0][0] == '_') {
@@ -314,34 +405,53 @@ void Type::expand(std::vector<std::string>& values, const MarsRequest& request)
     }
 }
 
-void Type::setDefaults(MarsRequest& request) {
-    if (inheritance_) {
-        request.setValuesTyped(this, inheritance_.value());
+TypedValue Type::encode(const std::string&) const {
+    return {};
+}
+
+std::string Type::decode(const TypedValue&) const {
+    std::ostringstream oss;
+    oss << *this << ": values have no binary form";
+    throw eckit::SeriousBug(oss.str());
+}
+
+std::shared_ptr<const ValueRange> Type::range(const std::vector<std::string>& values,
+                                              const MarsRequest& request) const {
+    // The values of a range are distinct and already tidied, only plain lists of values that need no checking are kept
+    // unexpanded
+    if (!toByList_ || !multiple_ || hasGroups() || !acceptsRanges()) {
+        return nullptr;
     }
-    else {
-        bool unset = false;
-        for (const auto& unsetContext : unsets_) {
-            if (unsetContext->matches(request)) {
-                unset = true;
-                break;
-            }
-        }
-        if (!unset) {
-            for (const auto& [defaultContext, values] : defaults_) {
-                if (defaultContext->matches(request)) {
-                    patchRequest(request, values);
-                    break;
-                }
-            }
-        }
+    return toByList_->range(values, request);
+}
+
+void Type::compact(std::vector<std::string>& values, const MarsRequest& request) const {
+    if (toByList_ && multiple_ && !hasGroups() && values.size() > 2) {
+        toByList_->compactRanges(values, request);
     }
 }
 
-void Type::setInheritance(const std::vector<std::string>& inheritance) {
-    inheritance_ = inheritance;
+void Type::setDefaults(MarsRequest& request) const {
+    ContextCache cache;
+    setDefaults(request, cache);
+}
+
+void Type::setDefaults(MarsRequest& request, ContextCache& cache) const {
+    for (const auto& unsetContext : unsets_) {
+        if (unsetContext->matches(request, cache)) {
+            return;
+        }
+    }
+    for (const auto& [defaultContext, values] : defaults_) {
+        if (defaultContext->matches(request, cache)) {
+            patchRequest(request, values);
+            cache.invalidate(keyId_);
+            break;
+        }
+    }
 }
 
-const std::vector<std::string>& Type::flattenValues(const MarsRequest& request) {
+const std::vector<std::string>& Type::flattenValues(const MarsRequest& request) const {
     return request.values(name_);
 }
 
@@ -349,10 +459,6 @@ void Type::clearDefaults() {
     defaults_.clear();
 }
 
-void Type::reset() {
-    inheritance_.reset();
-}
-
 const std::string& Type::name() const {
     return name_;
 }
@@ -361,37 +467,46 @@ const std::string& Type::category() const {
     return category_;
 }
 
-void Type::pass2(MarsRequest& request) {}
+void Type::pass2(MarsRequest& request) const {}
+
+void Type::finalise(MarsRequest& request, bool strict) const {
+    ContextCache cache;
+    finalise(request, strict, cache);
+}
 
-void Type::finalise(MarsRequest& request, bool strict) {
+void Type::finalise(MarsRequest& request, bool strict, ContextCache& cache) const {
 
-    const std::vector<std::string>& values = request.values(name_, true);
-    if (values.size() == 1 && values[0] == "off") {
+    // Only the number of values is needed, a range is not materialised
+    size_t count = request.countValues(name_);
+    if (count == 1 && request.values(name_)[0] == "off") {
         request.unsetValues(name_);
+        cache.invalidate(keyId_);
     }
     else {
-        if (values.size() > 0) {
+        if (count > 0) {
             for (const auto& context : unsets_) {
-                if (context->matches(request)) {
+                if (context->matches(request, cache)) {
                     if (strict && request.has(name_)) {
                         std::ostringstream oss;
                         oss << *this << ": Key [" << name_ << "] not acceptable with context: " << *context;
                         throw eckit::UserError(oss.str());
                     }
                     request.unsetValues(name_);
+                    cache.invalidate(keyId_);
                 }
             }
         }
 
         if (request.verb() != "list") {
             for (const auto& [context, values] : sets_) {
-                if (context->matches(request)) {
+                if (context->matches(request, cache)) {
                     if (strict && !request.has(name_)) {
                         std::ostringstream oss;
                         oss << *this << ": missing Key [" << name_ << "] - required with context: " << *context;
                         throw eckit::UserError(oss.str());
                     }
                     patchRequest(request, values);
+                    cache.invalidate(keyId_);
                 }
             }
         }
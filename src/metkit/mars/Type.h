@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <memory>
@@ -27,6 +28,7 @@
 #include "eckit/value/Value.h"
 
 #include "metkit/mars/MarsRequest.h"
+#include "metkit/mars/TypedValue.h"
 
 namespace metkit::mars {
 
@@ -43,7 +45,16 @@ public:
 
     const std::string& key() const { return key_; }
 
-    virtual bool matches(MarsRequest req) const = 0;
+    virtual bool matches(const MarsRequest& req) const = 0;
+
+    /// Equal rules are shared by all the contexts using them (see Context::add) and have the same id
+    size_t id() const { return id_; }
+
+    /// Identifies the keyword tested by the rule, see ContextRule::keyId(key)
+    size_t keyId() const { return keyId_; }
+
+    /// Small integer identifying a keyword, stable for the lifetime of the process (see Keyword)
+    static size_t keyId(const std::string& key);
 
     friend std::ostream& operator<<(std::ostream& s, const ContextRule& r) {
         r.print(s);
@@ -57,6 +68,13 @@ protected:
 private:  // methods
 
     virtual void print(std::ostream& out) const = 0;
+
+private:  // members
+
+    friend class Context;
+
+    size_t id_    = 0;
+    size_t keyId_ = 0;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -68,7 +86,7 @@ public:
 
     Include(const std::string& k, const std::set<std::string>& vv) : ContextRule(k), vals_(vv) {}
 
-    bool matches(MarsRequest req) const override {
+    bool matches(const MarsRequest& req) const override {
         if (key_ == "_verb") {
             return (vals_.find(req.verb()) != vals_.end());
         }
@@ -98,7 +116,7 @@ class Exclude : public ContextRule {
 public:
 
     Exclude(const std::string& k, const std::set<std::string>& vv) : ContextRule(k), vals_(vv) {}
-    bool matches(MarsRequest req) const override {
+    bool matches(const MarsRequest& req) const override {
         if (!req.has(key_)) {
             return false;
         }
@@ -124,7 +142,7 @@ class Undef : public ContextRule {
 public:
 
     Undef(const std::string& k) : ContextRule(k) {}
-    bool matches(MarsRequest req) const override { return !req.has(key_); }
+    bool matches(const MarsRequest& req) const override { return !req.has(key_); }
 
 private:  // methods
 
@@ -136,7 +154,7 @@ class Def : public ContextRule {
 public:
 
     Def(const std::string& k) : ContextRule(k) {}
-    bool matches(MarsRequest req) const override { return req.has(key_); }
+    bool matches(const MarsRequest& req) const override { return req.has(key_); }
 
 private:  // methods
 
@@ -144,6 +162,27 @@ private:  // methods
 };
 
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Results of the ContextRules already evaluated against one request. As rules are shared between contexts, a
+/// condition such as class=od is evaluated once per request, however many defaults, sets and unsets depend on it.
+/// The results depending on a keyword must be invalidated whenever the values of that keyword change.
+class ContextCache {
+public:
+
+    bool matches(const ContextRule& rule, const MarsRequest& request);
+
+    void invalidate(size_t keyId);
+
+    void clear();
+
+private:
+
+    std::vector<uint64_t> known_;
+    std::vector<uint64_t> results_;
+    std::vector<std::pair<size_t, size_t>> evaluated_;  // (keyId, id) of the cached rules
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 
 /// @brief a Context contains a list of ContextRule. A MarsRequest matches a context, if it matches all the ContextRules
@@ -153,12 +192,13 @@ public:
 
     static std::unique_ptr<Context> parseContext(eckit::Value c);
 
-    /// @note takes ownership of the rule
+    /// @note takes ownership of the rule, which is replaced by an equal rule added earlier to any context, if any
     void add(std::unique_ptr<ContextRule> rule);
 
     size_t maxAxisIndex() const;
 
-    bool matches(MarsRequest req) const;
+    bool matches(const MarsRequest& req) const;
+    bool matches(const MarsRequest& req, ContextCache& cache) const;
 
     friend std::ostream& operator<<(std::ostream& s, const Context& x);
 
@@ -168,7 +208,7 @@ private:  // methods
 
 private:
 
-    std::vector<std::unique_ptr<ContextRule>> rules_;
+    std::vector<std::shared_ptr<const ContextRule>> rules_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -178,6 +218,13 @@ public:
 
     virtual ~ITypeToByList()                                                                      = default;
     virtual void expandRanges(std::vector<std::string>& values, const MarsRequest& request) const = 0;
+
+    /// Rewrites the runs of evenly spaced values as from/to/by lists, the inverse of expandRanges()
+    virtual void compactRanges(std::vector<std::string>& values, const MarsRequest& request) const = 0;
+
+    /// The values as an unexpanded range if they are a single from/to/by list, nullptr otherwise
+    virtual std::shared_ptr<const ValueRange> range(const std::vector<std::string>& values,
+                                                    const MarsRequest& request) const = 0;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -194,16 +241,32 @@ public:  // methods
 
     std::string tidy(const std::string& value, const MarsRequest& request = {}) const;
 
-    virtual void setDefaults(MarsRequest& request);
-    virtual void setInheritance(const std::vector<std::string>& inheritance);
+    /// Binary form of an expanded value, used to compare values without parsing them (see Parameter::typed()). The
+    /// value has none if it is not in the canonical form produced by expand(), or if the type has no binary form
+    virtual TypedValue encode(const std::string& value) const;
+
+    /// The canonical form of a value returned by encode()
+    virtual std::string decode(const TypedValue& value) const;
+
+    /// Same as expand(), but returns a range of values that are expanded on demand if the values are a single
+    /// from/to/by list (e.g. date=19790101/to/20251231) of a type accepting ranges, nullptr otherwise
+    std::shared_ptr<const ValueRange> range(const std::vector<std::string>& values,
+                                            const MarsRequest& request = {}) const;
+
+    /// Rewrites the runs of evenly spaced values of an expanded list (dates, steps, levels, ...) as from/to/by lists,
+    /// which expand() turns back into the same values. The values are left as they are for other types
+    void compact(std::vector<std::string>& values, const MarsRequest& request = {}) const;
+
+    void setDefaults(MarsRequest& request) const;
+    virtual void setDefaults(MarsRequest& request, ContextCache& cache) const;
     virtual void check(const std::vector<std::string>& values) const;
     virtual void clearDefaults();
-    virtual void reset();
 
-    virtual void pass2(MarsRequest& request);
-    virtual void finalise(MarsRequest& request, bool strict);
+    virtual void pass2(MarsRequest& request) const;
+    void finalise(MarsRequest& request, bool strict) const;
+    virtual void finalise(MarsRequest& request, bool strict, ContextCache& cache) const;
 
-    virtual const std::vector<std::string>& flattenValues(const MarsRequest& request);
+    virtual const std::vector<std::string>& flattenValues(const MarsRequest& request) const;
     virtual bool flatten() const;
     virtual bool multiple() const;
 
@@ -215,6 +278,9 @@ public:  // methods
     const std::string& name() const;
     const std::string& category() const;
 
+    /// Interned id of the name, see Keyword
+    size_t keyId() const { return keyId_; }
+
     friend std::ostream& operator<<(std::ostream& s, const Type& x);
 
     virtual size_t count(const std::vector<std::string>& values) const;
@@ -222,6 +288,10 @@ public:  // methods
 protected:  // methods
 
     virtual bool hasGroups() const { return false; }
+
+    /// Whether every value of a from/to/by list with valid bounds is valid, and passes check(), so that the list can be
+    /// kept unexpanded without checking its values one by one. Types restricting their values return false
+    virtual bool acceptsRanges() const { return true; }
     virtual std::optional<std::reference_wrapper<const std::vector<std::string>>> group(const std::string&) const {
         NOTIMP;
     }
@@ -235,6 +305,7 @@ protected:  // methods
 protected:  // members
 
     std::string name_;
+    size_t keyId_;  // see ContextRule::keyId()
     std::string category_;
 
     bool flatten_;
@@ -245,8 +316,6 @@ protected:  // members
     std::map<std::shared_ptr<Context>, std::vector<std::string>> sets_;
     std::set<std::shared_ptr<Context>> unsets_;
 
-    std::optional<std::vector<std::string>> inheritance_;
-
     std::unique_ptr<ITypeToByList> toByList_;
 
     std::map<std::string, std::function<bool(const std::vector<std::string>&, std::vector<std::string>&)>> filters_;
@@ -254,7 +323,7 @@ protected:  // members
 private:  // methods
 
     virtual void print(std::ostream& out) const = 0;
-    void patchRequest(MarsRequest& request, const std::vector<std::string>& values);
+    void patchRequest(MarsRequest& request, const std::vector<std::string>& values) const;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
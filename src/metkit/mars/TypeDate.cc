@@ -122,9 +122,9 @@ TypeDate::TypeDate(const std::string& name, const eckit::Value& settings) : Type
     filters_["day"] = &filterByDay;
 }
 
-void TypeDate::pass2(MarsRequest& request) {
-    std::vector<std::string> values = request.values(name_, true);
-    if (values.size() == 1 && values[0] == "-1") {
+void TypeDate::pass2(MarsRequest& request) const {
+    if (request.countValues(name_) == 1 && request.values(name_)[0] == "-1") {
+        std::vector<std::string> values = request.values(name_);
         Type::expand(values, request);
         request.setValuesTyped(this, values);
     }
@@ -171,6 +171,26 @@ bool TypeDate::expand(std::string& value, const MarsRequest&) const {
     return true;
 }
 
+TypedValue TypeDate::encode(const std::string& value) const {
+    // canonical form, as produced by expand(): yyyymmdd. Climatology dates (e.g. jan-1) have no binary form
+    if (value.size() != 8 || value[0] == '0' ||
+        !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return {};
+    }
+
+    long yyyymmdd = std::stol(value);
+    long julian   = eckit::Date::dateToJulian(yyyymmdd);
+    if (eckit::Date::julianToDate(julian) != yyyymmdd) {  // not a valid date
+        return {};
+    }
+    return {TypedValue::Kind::Date, julian};
+}
+
+std::string TypeDate::decode(const TypedValue& value) const {
+    ASSERT(value.kind() == TypedValue::Kind::Date);
+    return std::to_string(eckit::Date::julianToDate(value.value()));
+}
+
 void TypeDate::print(std::ostream& out) const {
     out << "TypeDate[name=" << name_ << "]";
 }
@@ -30,10 +30,13 @@ public:  // methods
 
     ~TypeDate() noexcept override = default;
 
+    TypedValue encode(const std::string& value) const override;
+    std::string decode(const TypedValue& value) const override;
+
 private:  // methods
 
     void print(std::ostream& out) const override;
-    void pass2(MarsRequest& request) override;
+    void pass2(MarsRequest& request) const override;
     bool expand(std::string& value, const MarsRequest& request) const override;
 };
 
@@ -69,6 +69,16 @@ bool TypeFloat::expand(std::string& value, const MarsRequest&) const {
     return true;
 }
 
+TypedValue TypeFloat::encode(const std::string& value) const {
+    // Only whole numbers have a binary form, their canonical form is the same as for TypeInteger
+    return TypedValue::integer(value);
+}
+
+std::string TypeFloat::decode(const TypedValue& value) const {
+    ASSERT(value.kind() == TypedValue::Kind::Integer);
+    return std::to_string(value.value());
+}
+
 void TypeFloat::print(std::ostream& out) const {
     out << "TypeFloat[name=" << name() << "]";
 }
@@ -30,6 +30,9 @@ public:  // methods
 
     ~TypeFloat() noexcept override = default;
 
+    TypedValue encode(const std::string& value) const override;
+    std::string decode(const TypedValue& value) const override;
+
 private:  // methods
 
     void print(std::ostream& out) const override;
@@ -8,6 +8,8 @@
  * does it submit to any jurisdiction.
  */
 
+#include <string>
+
 #include "eckit/utils/Translator.h"
 
 #include "metkit/mars/MarsRequest.h"
@@ -77,6 +79,15 @@ bool TypeInteger::expand(std::string& value, const MarsRequest&) const {
     return false;
 }
 
+TypedValue TypeInteger::encode(const std::string& value) const {
+    return TypedValue::integer(value);
+}
+
+std::string TypeInteger::decode(const TypedValue& value) const {
+    ASSERT(value.kind() == TypedValue::Kind::Integer);
+    return std::to_string(value.value());
+}
+
 static TypeBuilder<TypeInteger> type("integer");
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -31,11 +31,17 @@ public:  // methods
 
     TypeInteger(const std::string& name, const eckit::Value& settings);
 
+    TypedValue encode(const std::string& value) const override;
+    std::string decode(const TypedValue& value) const override;
+
 protected:
 
     bool ok(const std::string& value, long& n) const;
     bool expand(std::string& value, const MarsRequest& request) const override;
 
+    /// Values outside of the range of the type are rejected one by one
+    bool acceptsRanges() const override { return !range_; }
+
 private:  // methods
 
     void print(std::ostream& out) const override;
@@ -10,23 +10,27 @@
 
 #include "metkit/mars/TypeParam.h"
 
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "eckit/config/Resource.h"
 #include "eckit/log/Log.h"
-#include "eckit/parser/YAMLParser.h"
-#include "eckit/thread/AutoLock.h"
 #include "eckit/types/Types.h"
 
+#include "metkit/config/ConfigSnapshot.h"
 #include "metkit/config/LibMetkit.h"
 #include "metkit/mars/MarsLanguage.h"
+#include "metkit/mars/PrefixMatcher.h"
 #include "metkit/mars/TypesFactory.h"
 
 using eckit::Log;
+using metkit::ConfigSnapshot;
 using metkit::LibMetkit;
 
 namespace {
 
-static eckit::Mutex* local_mutex = 0;
-static pthread_once_t once       = PTHREAD_ONCE_INIT;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
 
 
 class Matcher {
@@ -40,6 +44,9 @@ public:
 
     bool match(const metkit::mars::MarsRequest& request, bool partial = false) const;
 
+    const std::string& name() const { return name_; }
+    const eckit::Value& values() const { return values_; }
+
     friend std::ostream& operator<<(std::ostream& out, const Matcher& matcher) {
         out << matcher.name_ << "=" << matcher.values_;
         return out;
@@ -80,8 +87,14 @@ class Rule {
     std::vector<std::string> values_;
     mutable std::map<std::string, std::string> mapping_;
 
+    // Frozen lookup tables, built once the values and mappings are known
+    std::unordered_set<std::string> ids_;
+    metkit::mars::PrefixMatcher matcher_;
+
     static std::vector<std::string> defaultValues_;
     static std::map<std::string, std::string> defaultMapping_;
+    static std::unordered_set<std::string> defaultIds_;
+    static metkit::mars::PrefixMatcher defaultMatcher_;
 
 public:
 
@@ -89,6 +102,8 @@ public:
     std::string lookup(const std::string& s, bool fail) const;
     long toParamid(const std::string& param) const;
 
+    const std::vector<Matcher>& matchers() const { return matchers_; }
+
     Rule(const eckit::Value& matchers, const eckit::Value& setters, const eckit::Value& ids);
     static void setDefault(const eckit::Value& setters, const eckit::Value& ids);
 
@@ -110,6 +125,8 @@ public:
 
 std::vector<std::string> Rule::defaultValues_;
 std::map<std::string, std::string> Rule::defaultMapping_;
+std::unordered_set<std::string> Rule::defaultIds_;
+metkit::mars::PrefixMatcher Rule::defaultMatcher_;
 
 void Rule::setDefault(const eckit::Value& values, const eckit::Value& ids) {
 
@@ -160,6 +177,9 @@ void Rule::setDefault(const eckit::Value& values, const eckit::Value& ids) {
             defaultValues_.push_back(v);
         }
     }
+
+    defaultIds_     = std::unordered_set<std::string>(defaultValues_.begin(), defaultValues_.end());
+    defaultMatcher_ = metkit::mars::PrefixMatcher(defaultValues_, defaultMapping_);
 }
 
 Rule::Rule(const eckit::Value& matchers, const eckit::Value& values, const eckit::Value& ids) {
@@ -217,6 +237,9 @@ Rule::Rule(const eckit::Value& matchers, const eckit::Value& values, const eckit
             values_.push_back(v);
         }
     }
+
+    ids_     = std::unordered_set<std::string>(values_.begin(), values_.end());
+    matcher_ = metkit::mars::PrefixMatcher(values_, mapping_);
 }
 
 
@@ -279,39 +302,149 @@ std::string Rule::lookup(const std::string& s, bool fail) const {
         oss << table * 1000 + param;
 
         std::string p = oss.str();
-        for (std::vector<std::string>::const_iterator j = values_.begin(); j != values_.end(); ++j) {
-            if ((*j) == p) {
-                return p;
+        if (ids_.find(p) != ids_.end() || defaultIds_.find(p) != defaultIds_.end()) {
+            return p;
+        }
+
+        throw eckit::UserError("Cannot match parameter " + p, Here());
+    }
+
+    // An exact match (ignoring case) wins, in the values of the rule then in the default ones
+    std::string paramid = matcher_.match(s, false, false, true);
+    if (!paramid.empty()) {
+        return paramid;
+    }
+
+    if (const std::string* value = defaultMatcher_.exact(s)) {
+        return *value;
+    }
+
+    return defaultMatcher_.match(s, fail, false, false);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Immutable index of the rules by the values of their context keywords. For each keyword, each value maps to the set
+/// of rules accepting it, and rules that do not constrain the keyword accept any value. The rules matching a request
+/// are the intersection of these sets over all keywords, so that the rules are never scanned.
+class RuleIndex {
+
+    using Bits = std::vector<uint64_t>;
+
+    struct Keyword {
+        std::string name;
+        std::unordered_map<std::string, Bits> values;
+        Bits any;  // rules without a matcher on this keyword
+    };
+
+    const std::vector<Rule>& rules_;
+    std::vector<Keyword> keywords_;
+
+    Bits candidates(const metkit::mars::MarsRequest& request, bool partial) const;
+
+public:
+
+    explicit RuleIndex(const std::vector<Rule>& rules);
+
+    /// First rule matching the request, as Rule::match(), or nullptr
+    const Rule* first(const metkit::mars::MarsRequest& request, bool partial = false) const;
+
+    /// All the rules matching the request, in order
+    std::vector<const Rule*> matching(const metkit::mars::MarsRequest& request, bool partial = false) const;
+};
+
+RuleIndex::RuleIndex(const std::vector<Rule>& rules) : rules_(rules) {
+    const size_t words = (rules.size() + 63) / 64;
+
+    std::map<std::string, size_t> positions;
+    for (const auto& rule : rules) {
+        for (const auto& m : rule.matchers()) {
+            if (positions.emplace(m.name(), keywords_.size()).second) {
+                keywords_.push_back(Keyword{m.name(), {}, Bits(words, 0)});
             }
         }
+    }
 
-        for (std::vector<std::string>::const_iterator j = defaultValues_.begin(); j != defaultValues_.end(); ++j) {
-            if ((*j) == p) {
-                return p;
+    for (size_t i = 0; i < rules.size(); ++i) {
+        const uint64_t bit = uint64_t(1) << (i % 64);
+
+        std::vector<bool> constrained(keywords_.size(), false);
+        for (const auto& m : rules[i].matchers()) {
+            const size_t pos = positions[m.name()];
+            Keyword& k       = keywords_[pos];
+            constrained[pos] = true;
+            for (size_t j = 0; j < m.values().size(); ++j) {
+                std::string v = m.values()[j];
+                auto& bits    = k.values[v];
+                bits.resize(words, 0);
+                bits[i / 64] |= bit;
             }
         }
 
-        throw eckit::UserError("Cannot match parameter " + p, Here());
+        for (size_t k = 0; k < keywords_.size(); ++k) {
+            if (!constrained[k]) {
+                keywords_[k].any[i / 64] |= bit;
+            }
+        }
     }
+}
 
-    std::string paramid = metkit::mars::MarsLanguage::bestMatch(s, values_, false, false, true, mapping_);
-    if (!paramid.empty()) {
-        return paramid;
+RuleIndex::Bits RuleIndex::candidates(const metkit::mars::MarsRequest& request, bool partial) const {
+    Bits result(rules_.empty() ? 0 : (rules_.size() + 63) / 64, ~uint64_t(0));
+
+    for (const auto& k : keywords_) {
+        std::vector<std::string> vals = request.values(k.name, true);
+        if (vals.empty()) {
+            if (!partial) {
+                for (size_t w = 0; w < result.size(); ++w) {
+                    result[w] &= k.any[w];
+                }
+            }
+            continue;
+        }
+
+        auto j = k.values.find(vals[0]);
+        for (size_t w = 0; w < result.size(); ++w) {
+            result[w] &= (j == k.values.end()) ? k.any[w] : (k.any[w] | j->second[w]);
+        }
     }
 
-    return metkit::mars::MarsLanguage::bestMatch(s, defaultValues_, fail, false, false, defaultMapping_);
+    return result;
 }
 
-static std::vector<Rule>* rules = nullptr;
+const Rule* RuleIndex::first(const metkit::mars::MarsRequest& request, bool partial) const {
+    Bits bits = candidates(request, partial);
+    for (size_t w = 0; w < bits.size(); ++w) {
+        if (bits[w] != 0) {
+            size_t i = w * 64 + __builtin_ctzll(bits[w]);
+            return i < rules_.size() ? &rules_[i] : nullptr;
+        }
+    }
+    return nullptr;
+}
 
-}  // namespace
+std::vector<const Rule*> RuleIndex::matching(const metkit::mars::MarsRequest& request, bool partial) const {
+    std::vector<const Rule*> result;
+    Bits bits = candidates(request, partial);
+    for (size_t w = 0; w < bits.size(); ++w) {
+        for (uint64_t b = bits[w]; b != 0; b &= b - 1) {
+            size_t i = w * 64 + __builtin_ctzll(b);
+            if (i < rules_.size()) {
+                result.push_back(&rules_[i]);
+            }
+        }
+    }
+    return result;
+}
 
-static void init() {
+//----------------------------------------------------------------------------------------------------------------------
 
-    local_mutex = new eckit::Mutex();
-    rules       = new std::vector<Rule>();
+static std::vector<Rule>* rules = nullptr;
+static RuleIndex* index         = nullptr;
 
-    const eckit::Value ids = eckit::YAMLParser::decodeFile(LibMetkit::paramIDYamlFile());
+void readRules(std::vector<Rule>& rules) {
+
+    const eckit::Value ids = ConfigSnapshot::decodeFile(LibMetkit::paramIDYamlFile());
     ASSERT(ids.isOrderedMap());
 
     eckit::ValueMap merge;
@@ -321,10 +454,10 @@ static void init() {
     static bool metkitRawParam = eckit::Resource<bool>("metkitRawParam;$METKIT_RAW_PARAM", false);
 
     if (metkitLegacyParamCheck || (!metkitRawParam)) {
-        eckit::Value r = eckit::YAMLParser::decodeFile(LibMetkit::paramYamlFile());
+        eckit::Value r = ConfigSnapshot::decodeFile(LibMetkit::paramYamlFile());
         ASSERT(r.isList());
 
-        const eckit::Value rs = eckit::YAMLParser::decodeFile(LibMetkit::paramStaticYamlFile());
+        const eckit::Value rs = ConfigSnapshot::decodeFile(LibMetkit::paramStaticYamlFile());
         ASSERT(rs.isList());
 
         // merge r and rs
@@ -361,7 +494,7 @@ static void init() {
 
     if (metkitLegacyParamCheck) {
         for (auto it = merge.begin(); it != merge.end(); it++) {
-            (*rules).push_back(Rule(it->first, it->second, ids));
+            rules.push_back(Rule(it->first, it->second, ids));
         }
         return;
     }
@@ -371,14 +504,14 @@ static void init() {
 
     if (metkitRawParam) {
         // empty rule, to enable default
-        (*rules).push_back(Rule(eckit::Value::makeMap(), eckit::Value::makeList(), eckit::Value::makeMap()));
+        rules.push_back(Rule(eckit::Value::makeMap(), eckit::Value::makeList(), eckit::Value::makeMap()));
         return;
     }
 
     std::set<std::string> shortnames;
     std::set<std::string> associatedIDs;
 
-    const eckit::Value pc = eckit::YAMLParser::decodeFile(LibMetkit::shortnameContextYamlFile());
+    const eckit::Value pc = ConfigSnapshot::decodeFile(LibMetkit::shortnameContextYamlFile());
     ASSERT(pc.isList());
 
     for (size_t i = 0; i < pc.size(); i++) {
@@ -403,11 +536,19 @@ static void init() {
             }
         }
         if (listIDs.size() > 0) {
-            (*rules).push_back(Rule{it->first, listIDs, ids});
+            rules.push_back(Rule{it->first, listIDs, ids});
         }
     }
 
-    (*rules).push_back(Rule{eckit::Value::makeMap(), eckit::Value::makeList(), eckit::Value::makeMap()});
+    rules.push_back(Rule{eckit::Value::makeMap(), eckit::Value::makeList(), eckit::Value::makeMap()});
+}
+
+}  // namespace
+
+static void init() {
+    rules = new std::vector<Rule>();
+    readRules(*rules);
+    index = new RuleIndex(*rules);
 }
 
 namespace metkit::mars {
@@ -429,7 +570,7 @@ void TypeParam::print(std::ostream& out) const {
     out << "TypeParam[name=" << name_ << "]";
 }
 
-void TypeParam::pass2(MarsRequest& request) {
+void TypeParam::pass2(MarsRequest& request) const {
 
     pthread_once(&once, init);
 
@@ -441,30 +582,21 @@ void TypeParam::pass2(MarsRequest& request) {
         return;
     }
 
-    eckit::AutoLock<eckit::Mutex> lock(local_mutex);
-    for (const auto& r : *rules) {
-        if (r.match(request)) {
-            rule = &r;
-            break;
-        }
-    }
+    rule = index->first(request);
 
     if (!rule) {
         Log::warning() << "TypeParam: cannot find a context to expand 'param' in " << request << std::endl;
 
         if (firstRule_) {
-            bool found = false;
-            for (const auto& r : *rules) {
-                if (r.match(request, true)) {
-                    for (std::vector<std::string>::iterator j = values.begin(); j != values.end() && !rule; ++j) {
-                        std::string& s = (*j);
-                        try {
-                            s    = r.lookup(s, fail);
-                            rule = &r;
-                            Log::warning() << "TypeParam: using 'first matching rule' option " << r << std::endl;
-                        }
-                        catch (...) {
-                        }
+            for (const Rule* r : index->matching(request, true)) {
+                for (std::vector<std::string>::iterator j = values.begin(); j != values.end() && !rule; ++j) {
+                    std::string& s = (*j);
+                    try {
+                        s    = r->lookup(s, fail);
+                        rule = r;
+                        Log::warning() << "TypeParam: using 'first matching rule' option " << *r << std::endl;
+                    }
+                    catch (...) {
                     }
                 }
             }
@@ -476,12 +608,9 @@ void TypeParam::pass2(MarsRequest& request) {
                     tmp.setValue((*j).first, (*j).second);
                 }
             }
-            for (const auto& r : *rules) {
-                if (r.match(tmp)) {
-                    rule = &r;
-                    Log::warning() << "TypeParam using 'expand with' option " << *rule << std::endl;
-                    break;
-                }
+            rule = index->first(tmp);
+            if (rule) {
+                Log::warning() << "TypeParam using 'expand with' option " << *rule << std::endl;
             }
         }
         if (!rule) {
@@ -511,11 +640,6 @@ bool TypeParam::expand(std::string&, const MarsRequest&) const {
     return true;
 }
 
-void TypeParam::reset() {
-    // cache_.clear();
-    Type::reset();
-}
-
 static TypeBuilder<TypeParam> type("param");
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -7,6 +7,7 @@
  * granted to it by virtue of its status as an intergovernmental organisation nor
  * does it submit to any jurisdiction.
  */
+#include <cmath>
 #include <stdexcept>
 
 #include "metkit/mars/TypeRange.h"
@@ -52,6 +53,24 @@ bool TypeRange::expand(std::string& value, const MarsRequest&) const {
     return true;
 }
 
+TypedValue TypeRange::encode(const std::string& value) const {
+    try {
+        StepRange step{value};
+        if (std::string(step) != value) {  // not in the canonical form produced by expand()
+            return {};
+        }
+        return {TypedValue::Kind::Step, std::lround(step.from() * 3600), std::lround(step.to() * 3600)};
+    }
+    catch (...) {
+        return {};  // not a step
+    }
+}
+
+std::string TypeRange::decode(const TypedValue& value) const {
+    ASSERT(value.kind() == TypedValue::Kind::Step);
+    return StepRange{eckit::Time(value.value(), true), eckit::Time(value.extra(), true)};
+}
+
 static TypeBuilder<TypeRange> type("range");
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -8,6 +8,8 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cctype>
 #include <iomanip>
 #include <regex>
 
@@ -45,6 +47,29 @@ bool TypeTime::expand(std::string& value, const MarsRequest&) const {
     return true;
 }
 
+TypedValue TypeTime::encode(const std::string& value) const {
+    // canonical form, as produced by expand(): hhmm
+    if (value.size() != 4 ||
+        !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return {};
+    }
+
+    int hours   = (value[0] - '0') * 10 + (value[1] - '0');
+    int minutes = (value[2] - '0') * 10 + (value[3] - '0');
+    if (hours >= 24 || minutes >= 60) {
+        return {};
+    }
+    return {TypedValue::Kind::Time, hours * 3600 + minutes * 60};
+}
+
+std::string TypeTime::decode(const TypedValue& value) const {
+    ASSERT(value.kind() == TypedValue::Kind::Time);
+    std::ostringstream oss;
+    oss << std::setfill('0') << std::setw(2) << value.value() / 3600 << std::setfill('0') << std::setw(2)
+        << (value.value() % 3600) / 60;
+    return oss.str();
+}
+
 void TypeTime::print(std::ostream& out) const {
     out << "TypeTime[name=" << name_ << "]";
 }
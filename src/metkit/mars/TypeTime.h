@@ -31,6 +31,9 @@ public:  // methods
 
     ~TypeTime() noexcept override = default;
 
+    TypedValue encode(const std::string& value) const override;
+    std::string decode(const TypedValue& value) const override;
+
 private:  // methods
 
     void print(std::ostream& out) const override;
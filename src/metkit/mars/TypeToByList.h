@@ -14,18 +14,132 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <sstream>
+
 #include "eckit/exception/Exceptions.h"
+#include "eckit/types/Date.h"
+#include "eckit/types/Time.h"
 #include "eckit/utils/StringTools.h"
 #include "eckit/utils/Translator.h"
 
+#include "metkit/mars/MarsRequest.h"
+#include "metkit/mars/StepRange.h"
 #include "metkit/mars/Type.h"
+#include "metkit/mars/ValueRange.h"
 
 namespace metkit::mars {
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/// alwaysValid: whether every element of a sequence of EL is a valid value of a type accepting ranges (see
+/// Type::acceptsRanges()), so that a range can be counted without formatting its elements.
+/// step(a, b): the 'by' of a sequence going from a to b in one step, empty if there is none. It is only a guess, the
+/// values are compacted into a sequence only if expanding the sequence gives them back.
+template <typename EL>
+struct ToByListTraits {
+    static constexpr bool alwaysValid = false;
+    static std::string step(const EL&, const EL&) { return {}; }
+};
+
+template <>
+struct ToByListTraits<long> {
+    static constexpr bool alwaysValid = true;
+    static std::string step(long a, long b) { return std::to_string(std::labs(b - a)); }
+};
+
+template <>
+struct ToByListTraits<eckit::Date> {
+    static constexpr bool alwaysValid = true;
+    static std::string step(const eckit::Date& a, const eckit::Date& b) { return std::to_string(std::labs(b - a)); }
+};
+
+template <>
+struct ToByListTraits<eckit::Time> {
+    static constexpr bool alwaysValid = false;
+    static std::string step(const eckit::Time& a, const eckit::Time& b) {
+        long seconds = std::lround(std::fabs(static_cast<double>(b) - static_cast<double>(a)));
+        if (seconds % 3600 == 0) {
+            return std::to_string(seconds / 3600) + "h";
+        }
+        return seconds % 60 == 0 ? std::to_string(seconds / 60) + "m" : std::to_string(seconds) + "s";
+    }
+};
+
+template <>
+struct ToByListTraits<float> {
+    static constexpr bool alwaysValid = false;
+    static std::string step(float a, float b) { return eckit::Translator<float, std::string>()(std::fabs(b - a)); }
+};
+
+template <>
+struct ToByListTraits<StepRange> {
+    static constexpr bool alwaysValid = true;
+    static std::string step(const StepRange& a, const StepRange& b) {
+        if (b.from() - a.from() != b.to() - a.to()) {
+            return {};
+        }
+        long minutes = std::lround(std::fabs(b.from() - a.from()) * 60);
+        return minutes % 60 == 0 ? std::to_string(minutes / 60) : std::to_string(minutes) + "m";
+    }
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 template <typename EL, typename BY>
 class TypeToByList : public ITypeToByList {
 
+private:  // types
+
+    struct Sequence {
+        std::string from_s;
+        std::string to_s;
+        std::string by_s;
+        EL from;
+        EL to;
+        BY by;
+        bool addBy;
+    };
+
+    /// A from/to/by list of this type, expanded on demand. The range keeps the type attached, and a copy of the
+    /// request its bounds were tidied against, so that it can outlive the request and the language it came from.
+    class Range : public ValueRange {
+    public:
+
+        Range(const Type& type, Sequence sequence, const MarsRequest& request) :
+            type_(type), sequence_(std::move(sequence)), request_(request) {
+            type_.attach();
+        }
+
+        ~Range() override { type_.detach(); }
+
+        Range(const Range&)            = delete;
+        Range& operator=(const Range&) = delete;
+
+        void forEach(const std::function<void(const std::string&)>& f) const override {
+            f(sequence_.from_s);
+            follow(type_, sequence_, request_, true, f);
+        }
+
+    private:
+
+        size_t count() const override {
+            size_t n = 1;
+            follow(type_, sequence_, request_, false, [&n](const std::string&) { ++n; });
+            return n;
+        }
+
+        void print(std::ostream& out) const override {
+            out << sequence_.from_s << "/to/" << sequence_.to_s << "/by/" << sequence_.by_s;
+        }
+
+        const Type& type_;
+        const Sequence sequence_;
+        const MarsRequest request_;
+    };
+
 private:  // members
 
     const Type& type_;
@@ -44,91 +158,232 @@ public:  // methods
             return;
         }
 
-        static eckit::Translator<std::string, EL> s2el;
-        static eckit::Translator<std::string, BY> s2by;
-        static eckit::Translator<EL, std::string> el2s;
-
         std::vector<std::string> newval;
 
         for (size_t i = 0; i < values.size(); ++i) {
 
             const std::string& s = values[i];
 
-            if (eckit::StringTools::lower(s) == "to" || eckit::StringTools::lower(s) == "t0") {
-                // TimeUnit unit;
-
+            if (isTo(s)) {
                 if (newval.size() == 0) {
                     std::ostringstream oss;
                     oss << type_.name() << " list: 'to' must be preceeded by a starting value.";
                     throw eckit::BadValue(oss.str());
                 }
-                if (values.size() <= i + 1) {
-                    std::ostringstream oss;
-                    oss << type_.name() << " list: 'to' must be followed by an ending value.";
-                    throw eckit::BadValue(oss.str());
-                }
 
-                EL from          = s2el(type_.tidy(values[i - 1], request));
-                std::string to_s = type_.tidy(values[i + 1], request);
-                EL to            = s2el(to_s);
-                BY by            = s2by(by_);
+                Sequence sequence = parse(values, i, request);
+                follow(type_, sequence, request, true, [&newval](const std::string& v) { newval.push_back(v); });
+            }
+            else {
+                newval.push_back(type_.tidy(s, request));
+            }
+        }
 
-                if (i + 2 < values.size() && eckit::StringTools::lower(values[i + 2]) == "by") {
-                    if (values.size() <= i + 3) {
-                        std::ostringstream oss;
-                        oss << type_.name() << " list: 'by' must be followed by a step size.";
-                        throw eckit::BadValue(oss.str());
+        std::swap(values, newval);
+    }
+
+    void compactRanges(std::vector<std::string>& values, const MarsRequest& request) const override {
+
+        eckit::Translator<std::string, EL> s2el;
+
+        std::vector<std::string> newval;
+
+        size_t i = 0;
+        while (i < values.size()) {
+
+            // the longest run of values from values[i], going the same way with the same step
+            size_t end = i + 1;
+            std::string by;
+            try {
+                if (i + 2 < values.size()) {
+                    EL first = s2el(values[i]);
+                    EL prev  = s2el(values[i + 1]);
+                    bool up  = first < prev;
+                    by       = (up || prev < first) ? ToByListTraits<EL>::step(first, prev) : std::string();
+                    for (end = by.empty() ? end : i + 2; !by.empty() && end < values.size(); ++end) {
+                        EL next = s2el(values[end]);
+                        if (!(up ? prev < next : next < prev) || ToByListTraits<EL>::step(prev, next) != by) {
+                            break;
+                        }
+                        prev = next;
                     }
+                }
+            }
+            catch (std::exception&) {
+                // not a value of this type, left as it is
+            }
 
-                    by = s2by(values[i + 3]);
-                    i += 2;
+            if (end - i >= 3 && shorter(values, i, end, by) && expandsTo(values, i, end, by, request)) {
+                newval.push_back(values[i]);
+                newval.push_back("to");
+                newval.push_back(values[end - 1]);
+                if (by != by_) {
+                    newval.push_back("by");
+                    newval.push_back(by);
                 }
-                i++;
+                i = end;
+            }
+            else {
+                newval.push_back(values[i++]);
+            }
+        }
 
-                if (by == BY{0}) {
-                    std::ostringstream oss;
-                    oss << type_.name() + ": 'by' value " << by << " cannot be zero";
-                    throw eckit::BadValue(oss.str());
+        std::swap(values, newval);
+    }
+
+    std::shared_ptr<const ValueRange> range(const std::vector<std::string>& values,
+                                            const MarsRequest& request) const override {
+
+        if (values.size() != 3 && (values.size() != 5 || eckit::StringTools::lower(values[3]) != "by")) {
+            return nullptr;
+        }
+        if (isTo(values[0]) || !isTo(values[1])) {
+            return nullptr;
+        }
+
+        // The bounds must be values of the type, as Type::expand() requires of every value. The elements in between
+        // then are, as the type accepts ranges
+        for (const std::string& bound : {values[0], values[2]}) {
+            std::string value = bound;
+            if (!type_.expand(value, request)) {
+                std::ostringstream oss;
+                oss << type_ << ": cannot expand '" << bound << "'";
+                throw eckit::UserError(oss.str());
+            }
+        }
+
+        size_t i = 1;
+        return std::make_shared<Range>(type_, parse(values, i, request), request);
+    }
+
+private:  // methods
+
+    static bool isTo(const std::string& s) {
+        std::string l = eckit::StringTools::lower(s);
+        return l == "to" || l == "t0";
+    }
+
+    /// Parses the bounds of the list whose 'to' is values[i], and moves i to its last element
+    Sequence parse(const std::vector<std::string>& values, size_t& i, const MarsRequest& request) const {
+
+        eckit::Translator<std::string, EL> s2el;
+        eckit::Translator<std::string, BY> s2by;
+
+        if (values.size() <= i + 1) {
+            std::ostringstream oss;
+            oss << type_.name() << " list: 'to' must be followed by an ending value.";
+            throw eckit::BadValue(oss.str());
+        }
+
+        std::string from_s = type_.tidy(values[i - 1], request);
+        std::string to_s   = type_.tidy(values[i + 1], request);
+        std::string by_s   = by_;
+
+        if (i + 2 < values.size() && eckit::StringTools::lower(values[i + 2]) == "by") {
+            if (values.size() <= i + 3) {
+                std::ostringstream oss;
+                oss << type_.name() << " list: 'by' must be followed by a step size.";
+                throw eckit::BadValue(oss.str());
+            }
+
+            by_s = values[i + 3];
+            i += 2;
+        }
+        i++;
+
+        EL from = s2el(from_s);
+        EL to   = s2el(to_s);
+        BY by   = s2by(by_s);
+
+        if (by == BY{0}) {
+            std::ostringstream oss;
+            oss << type_.name() + ": 'by' value " << by << " cannot be zero";
+            throw eckit::BadValue(oss.str());
+        }
+        if (from < to && by < BY{0}) {
+            std::ostringstream oss;
+            oss << type_.name() << ": impossible to define a sequence starting from " << from << " to " << to
+                << " with step " << by;
+            throw eckit::BadValue(oss.str());
+        }
+        bool addBy = (from < to && by > BY{0}) || (from > to && by < BY{0});
+
+        return Sequence{from_s, to_s, by_s, from, to, by, addBy};
+    }
+
+    /// Whether values[begin, end) are shorter written as a from/to/by list
+    bool shorter(const std::vector<std::string>& values, size_t begin, size_t end, const std::string& by) const {
+        size_t list = end - begin - 1;
+        for (size_t i = begin; i < end; ++i) {
+            list += values[i].size();
+        }
+        size_t range = values[begin].size() + values[end - 1].size() + 4 + (by == by_ ? 0 : by.size() + 4);
+        return range < list;
+    }
+
+    /// Whether the from/to/by list from values[begin] to values[end - 1] expands to values[begin, end)
+    bool expandsTo(const std::vector<std::string>& values, size_t begin, size_t end, const std::string& by,
+                   const MarsRequest& request) const {
+        try {
+            std::vector<std::string> list{values[begin], "to", values[end - 1], "by", by};
+            size_t i          = 1;
+            Sequence sequence = parse(list, i, request);
+
+            size_t next = begin + 1;
+            bool same   = sequence.from_s == values[begin];
+            follow(type_, sequence, request, true, [&](const std::string& v) {
+                same = same && next < end && v == values[next];
+                next++;
+            });
+            return same && next == end;
+        }
+        catch (std::exception&) {
+            return false;
+        }
+    }
+
+    /// Calls f with each element following from, up to to. Unless format is set, elements of a type that accepts all
+    /// of them are only formatted where needed to detect the end of the sequence, and f is called with an empty string
+    template <typename F>
+    static void follow(const Type& type, const Sequence& s, const MarsRequest& request, bool format, F&& f) {
+
+        eckit::Translator<EL, std::string> el2s;
+
+        format = format || !ToByListTraits<EL>::alwaysValid;
+
+        EL j = s.from;
+        while (j != s.to) {
+            std::string j_s;
+            try {
+                if (s.addBy) {
+                    j += s.by;
                 }
-                if (from < to && by < BY{0}) {
-                    std::ostringstream oss;
-                    oss << type_.name() << ": impossible to define a sequence starting from " << from << " to " << to
-                        << " with step " << by;
-                    throw eckit::BadValue(oss.str());
+                else {
+                    j -= s.by;
                 }
-                bool addBy = (from < to && by > BY{0}) || (from > to && by < BY{0});
-                if (from == to) {
-                    continue;
+                if (format) {
+                    j_s = type.tidy(el2s(j), request);
                 }
+            }
+            catch (...) {
+                break;  /// reached an invalid value
+            }
 
-                EL j = from;
-                while (j != to) {
-                    std::string j_s;
+            if (((s.from < s.to && j > s.to) || (s.from > s.to && j < s.to)) && j != s.to) {
+                if (!format) {
                     try {
-                        if (addBy) {
-                            j += by;
-                        }
-                        else {
-                            j -= by;
-                        }
-                        j_s = type_.tidy(el2s(j), request);
+                        j_s = type.tidy(el2s(j), request);
                     }
                     catch (...) {
-                        break;  /// reached an invalid value
-                    }
-
-                    if (((from < to && j > to) || (from > to && j < to)) && j != to && j_s != to_s) {
                         break;
                     }
-                    newval.push_back(j_s);
+                }
+                if (j_s != s.to_s) {
+                    break;
                 }
             }
-            else {
-                newval.push_back(type_.tidy(s, request));
-            }
+            f(j_s);
         }
-
-        std::swap(values, newval);
     }
 };
 
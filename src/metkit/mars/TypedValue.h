@@ -0,0 +1,98 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   TypedValue.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Binary form of a value of a Type, see Type::encode()
+///
+/// Only values in their canonical (expanded) form have a binary form, so two values are equal if and only if their
+/// binary forms are, and comparing them does not need to parse any string.
+class TypedValue {
+public:  // types
+
+    enum class Kind : uint8_t {
+        None,     // no binary form
+        Integer,  // value
+        Date,     // julian day
+        Time,     // seconds
+        Step,     // seconds from and to
+    };
+
+public:  // methods
+
+    TypedValue() = default;
+    TypedValue(Kind kind, int64_t value, int64_t extra = 0) : kind_(kind), value_(value), extra_(extra) {}
+
+    Kind kind() const { return kind_; }
+    int64_t value() const { return value_; }
+    int64_t extra() const { return extra_; }
+
+    explicit operator bool() const { return kind_ != Kind::None; }
+
+    /// Binary form of an integer in canonical form (no leading zero, no '+' sign), none for any other string
+    static TypedValue integer(const std::string& value) {
+        size_t i = (!value.empty() && value[0] == '-') ? 1 : 0;
+        if (i == value.size() || value.size() > 18 || (value[i] == '0' && (i > 0 || value.size() > 1))) {
+            return {};
+        }
+
+        int64_t n = 0;
+        for (; i < value.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(value[i]))) {
+                return {};
+            }
+            n = n * 10 + (value[i] - '0');
+        }
+        return {Kind::Integer, value[0] == '-' ? -n : n};
+    }
+
+    bool operator==(const TypedValue& other) const {
+        return kind_ == other.kind_ && value_ == other.value_ && extra_ == other.extra_;
+    }
+    bool operator!=(const TypedValue& other) const { return !(*this == other); }
+    bool operator<(const TypedValue& other) const {
+        return std::tie(kind_, value_, extra_) < std::tie(other.kind_, other.value_, other.extra_);
+    }
+
+    size_t hash() const {
+        return std::hash<int64_t>{}(value_) ^ (std::hash<int64_t>{}(extra_) * 31) ^ static_cast<size_t>(kind_);
+    }
+
+private:  // members
+
+    Kind kind_     = Kind::None;
+    int64_t value_ = 0;
+    int64_t extra_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
+
+namespace std {
+template <>
+struct hash<metkit::mars::TypedValue> {
+    size_t operator()(const metkit::mars::TypedValue& v) const { return v.hash(); }
+};
+}  // namespace std
@@ -0,0 +1,35 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ValueRange.cc
+/// @date   Oct 2026
+
+#include "metkit/mars/ValueRange.h"
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t ValueRange::size() const {
+    std::call_once(sizeOnce_, [this] { size_ = count(); });
+    return size_;
+}
+
+const std::vector<std::string>& ValueRange::values() const {
+    std::call_once(valuesOnce_, [this] {
+        values_.reserve(size());
+        forEach([this](const std::string& v) { values_.push_back(v); });
+    });
+    return values_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   ValueRange.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metkit::mars {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief The values of a from/to/by list, kept unexpanded
+///
+/// A range only holds its bounds and its step, i.e. date=19790101/to/20251231 does not allocate a string per day. The
+/// values are counted or visited on demand, and only materialised when a caller asks for values(). A range is
+/// immutable and can be shared between requests and threads.
+class ValueRange {
+public:  // methods
+
+    virtual ~ValueRange() = default;
+
+    /// Number of values, computed without formatting them
+    size_t size() const;
+
+    /// Calls f with each value, in order, without keeping them
+    virtual void forEach(const std::function<void(const std::string&)>& f) const = 0;
+
+    /// The values, materialised on first use
+    const std::vector<std::string>& values() const;
+
+protected:  // methods
+
+    virtual size_t count() const = 0;
+
+    virtual void print(std::ostream&) const = 0;
+
+private:  // members
+
+    mutable std::once_flag sizeOnce_;
+    mutable std::once_flag valuesOnce_;
+    mutable size_t size_ = 0;
+    mutable std::vector<std::string> values_;
+
+    friend std::ostream& operator<<(std::ostream& s, const ValueRange& r) {
+        r.print(s);
+        return s;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars
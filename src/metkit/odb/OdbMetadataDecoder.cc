@@ -94,7 +94,7 @@ void OdbMetadataDecoder::visit(const std::string& columnName, const std::set<T>&
 
 OdbMetadataDecoder::OdbMetadataDecoder(eckit::message::MetadataGatherer& gather,
                                        const eckit::message::GetMetadataOptions& options, const std::string& verb) :
-    language_(verb), gather_(gather), options_(options) {}
+    language_(metkit::mars::MarsLanguage::instance(verb)), gather_(gather), options_(options) {}
 
 void OdbMetadataDecoder::operator()(const std::string& columnName, const std::set<long>& vals) {
     LOG_DEBUG_LIB(LibMetkit) << "OdbMetadataDecoder::operator() columnName: " << columnName << " vals: " << vals
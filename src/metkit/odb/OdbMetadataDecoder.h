@@ -49,7 +49,7 @@ private:  // methods
 
 private:  // members
 
-    metkit::mars::MarsLanguage language_;
+    const metkit::mars::MarsLanguage& language_;
     eckit::message::MetadataGatherer& gather_;
     eckit::message::GetMetadataOptions options_;
 };
@@ -11,6 +11,7 @@
 #include "metkit/odb/OdbToRequest.h"
 
 #include <algorithm>
+#include <optional>
 
 #include "eckit/io/DataHandle.h"
 #include "eckit/message/Message.h"
@@ -64,6 +65,7 @@ std::vector<MarsRequest> OdbToRequest::odbToRequest(DataHandle& dh) const {
     Frame frame;
 
     std::vector<MarsRequest> requests;
+    std::optional<MarsRequest::Merger> merger;  // merges all the requests in one, in linear time
 
     while ((frame = reader.next())) {
         Span span = frame.span(OdbMetadataDecoder::columnNames(), onlyConstantColumns_);
@@ -73,13 +75,20 @@ std::vector<MarsRequest> OdbToRequest::odbToRequest(DataHandle& dh) const {
         OdbMetadataDecoder decoder(setter, {}, verb_);
         span.visit(decoder);
 
-        if (one_ and requests.size()) {
-            requests.back().merge(r);
+        if (!one_) {
+            requests.push_back(std::move(r));
+        }
+        else if (merger) {
+            merger->add(r);
         }
         else {
-            requests.push_back(r);
+            merger.emplace(r);
         }
     }
+
+    if (merger) {
+        requests.push_back(std::move(*merger).request());
+    }
     return requests;
 }
 
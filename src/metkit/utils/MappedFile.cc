@@ -0,0 +1,56 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MappedFile.cc
+/// @date   Oct 2026
+
+#include "metkit/utils/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace metkit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MappedFile::MappedFile(const eckit::PathName& path) : path_(path) {
+    int fd = ::open(path.localPath(), O_RDONLY);
+    if (fd < 0) {
+        throw eckit::CantOpenFile(path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        ::close(fd);
+        throw eckit::FailedSystemCall("fstat " + path.asString());
+    }
+    size_ = st.st_size;
+    if (size_ > 0) {
+        addr_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (addr_ == MAP_FAILED) {
+        addr_ = nullptr;
+        throw eckit::FailedSystemCall("mmap " + path.asString());
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (addr_) {
+        ::munmap(addr_, size_);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit
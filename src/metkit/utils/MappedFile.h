@@ -0,0 +1,50 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MappedFile.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <cstddef>
+
+#include "eckit/filesystem/PathName.h"
+
+namespace metkit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Read-only memory mapping of a whole file
+///
+/// The mapping is private and read-only, so processes mapping the same file share its pages.
+class MappedFile {
+public:  // methods
+
+    explicit MappedFile(const eckit::PathName&);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const { return addr_; }
+    size_t size() const { return size_; }
+
+    const eckit::PathName& path() const { return path_; }
+
+private:  // members
+
+    eckit::PathName path_;
+    void* addr_  = nullptr;
+    size_t size_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit
@@ -0,0 +1,195 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MetadataPipeline.cc
+/// @date   Oct 2026
+
+#include "metkit/utils/MetadataPipeline.h"
+
+#include <algorithm>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/message/Reader.h"
+
+namespace metkit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void MetadataRecord::gather(eckit::message::MetadataGatherer& gatherer) const {
+    for (const auto& [key, value] : values_) {
+        std::visit([&, &key = key](const auto& v) { gatherer.setValue(key, v); }, value);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MetadataPipeline::MetadataPipeline(eckit::message::Reader& reader, const eckit::message::GetMetadataOptions& options,
+                                   size_t threads, size_t depth) :
+    MetadataPipeline([&reader] { return reader.next(); }, options, threads, depth) {}
+
+MetadataPipeline::MetadataPipeline(Source source, const eckit::message::GetMetadataOptions& options, size_t threads,
+                                   size_t depth) :
+    source_(std::move(source)), options_(options) {
+    // ecCodes may not be thread-safe, more workers are only used when asked for
+    static size_t defaultThreads = eckit::Resource<size_t>("metkitMetadataThreads;$METKIT_METADATA_THREADS", 1);
+
+    if (threads == 0) {
+        threads = std::max<size_t>(1, defaultThreads);
+    }
+    if (depth == 0) {
+        depth = 4 * threads;
+    }
+    slots_.resize(depth);
+
+    splitter_ = std::thread([this] { split(); });
+    workers_.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers_.emplace_back([this] { decode(); });
+    }
+}
+
+MetadataPipeline::~MetadataPipeline() {
+    stop();
+}
+
+void MetadataPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    splitterCV_.notify_all();
+    workerCV_.notify_all();
+    readerCV_.notify_all();
+
+    if (splitter_.joinable()) {
+        splitter_.join();
+    }
+    for (auto& w : workers_) {
+        if (w.joinable()) {
+            w.join();
+        }
+    }
+}
+
+void MetadataPipeline::split() {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            splitterCV_.wait(lock, [this] { return stopped_ || split_ - read_ < slots_.size(); });
+            if (stopped_) {
+                return;
+            }
+        }
+
+        // Only this thread touches the slot until it is marked as split
+        Slot& slot = slots_[split_ % slots_.size()];
+        std::exception_ptr error;
+        try {
+            slot.message = source_();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        // An error while splitting ends the input, after the messages split before it
+        bool last = error || !slot.message;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (last) {
+                splitError_ = std::move(error);
+                end_        = true;
+            }
+            else {
+                slot.state = State::Split;
+                ++split_;
+            }
+        }
+
+        if (last) {
+            workerCV_.notify_all();
+            readerCV_.notify_all();
+            return;
+        }
+        workerCV_.notify_one();
+    }
+}
+
+void MetadataPipeline::decode() {
+    for (;;) {
+        Slot* slot = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workerCV_.wait(lock, [this] { return stopped_ || decoding_ < split_ || end_; });
+            if (stopped_ || decoding_ == split_) {
+                return;
+            }
+            slot        = &slots_[decoding_ % slots_.size()];
+            slot->state = State::Decoding;
+            ++decoding_;
+        }
+
+        try {
+            slot->metadata.clear();
+            slot->message.getMetadata(slot->metadata, options_);
+        }
+        catch (...) {
+            slot->error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot->state = State::Done;
+        }
+        readerCV_.notify_all();
+    }
+}
+
+bool MetadataPipeline::next(eckit::message::Message& message, MetadataRecord& metadata) {
+    Slot* slot = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        readerCV_.wait(lock, [this] {
+            return stopped_ || (read_ < split_ && slots_[read_ % slots_.size()].state == State::Done) ||
+                   (end_ && read_ == split_);
+        });
+        if (stopped_) {
+            return false;
+        }
+        if (read_ == split_) {
+            if (splitError_) {
+                std::rethrow_exception(std::exchange(splitError_, nullptr));
+            }
+            return false;
+        }
+        slot = &slots_[read_ % slots_.size()];
+    }
+
+    std::exception_ptr error = std::exchange(slot->error, nullptr);
+    message                  = std::move(slot->message);
+    metadata.swap(slot->metadata);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot->state   = State::Free;
+        slot->message = eckit::message::Message();
+        ++read_;
+    }
+    splitterCV_.notify_one();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit
@@ -0,0 +1,152 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   MetadataPipeline.h
+/// @date   Oct 2026
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "eckit/message/Message.h"
+
+namespace eckit::message {
+class Reader;
+}
+
+namespace metkit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Metadata of a message, recorded in the order it was gathered, to be replayed into another gatherer
+class MetadataRecord : public eckit::message::MetadataGatherer {
+public:  // types
+
+    using Value = std::variant<std::string, long, double>;
+
+public:  // methods
+
+    void setValue(const std::string& key, const std::string& value) override { values_.emplace_back(key, value); }
+    void setValue(const std::string& key, long value) override { values_.emplace_back(key, value); }
+    void setValue(const std::string& key, double value) override { values_.emplace_back(key, value); }
+
+    /// Sets the values recorded, in the order they were recorded
+    void gather(eckit::message::MetadataGatherer&) const;
+
+    const std::vector<std::pair<std::string, Value>>& values() const { return values_; }
+
+    void clear() { values_.clear(); }
+    void swap(MetadataRecord& other) { values_.swap(other.values_); }
+
+private:  // members
+
+    std::vector<std::pair<std::string, Value>> values_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// @brief Reads messages and decodes their metadata on a pool of threads
+///
+/// One thread splits the messages, workers gather their metadata, and next() returns them in the order they were read.
+/// At most a fixed number of messages are in flight, so memory is bounded whatever the size of the input.
+///
+/// Errors are rethrown by next() in their place in the sequence of messages. An error decoding a message is thrown
+/// instead of it, and reading can go on. An error splitting the input ends it.
+/// Destroying the pipeline before the end of the input stops its threads.
+///
+/// Decoding with more than one worker requires an ecCodes built thread-safe (ENABLE_ECCODES_THREADS or
+/// ENABLE_ECCODES_OMP_THREADS), which is not checked: there is one worker unless more are asked for.
+class MetadataPipeline {
+public:  // types
+
+    /// Returns the next message, or a null message at the end of the input
+    using Source = std::function<eckit::message::Message()>;
+
+public:  // methods
+
+    /// @param threads number of workers, 0 for the default ($METKIT_METADATA_THREADS, or 1)
+    /// @param depth maximum number of messages in flight, 0 for four per worker
+    MetadataPipeline(Source, const eckit::message::GetMetadataOptions& = {}, size_t threads = 0, size_t depth = 0);
+
+    /// Reads from a reader, which must outlive the pipeline
+    MetadataPipeline(eckit::message::Reader&, const eckit::message::GetMetadataOptions& = {}, size_t threads = 0,
+                     size_t depth = 0);
+
+    ~MetadataPipeline();
+
+    MetadataPipeline(const MetadataPipeline&)            = delete;
+    MetadataPipeline& operator=(const MetadataPipeline&) = delete;
+
+    /// Next message and its metadata, in input order. Returns false at the end of the input, or once stopped.
+    bool next(eckit::message::Message&, MetadataRecord&);
+
+    /// Stops reading the input. The messages read but not returned yet are dropped, and next() returns false.
+    void stop();
+
+    size_t threads() const { return workers_.size(); }
+
+private:  // types
+
+    enum class State
+    {
+        Free,
+        Split,
+        Decoding,
+        Done,
+    };
+
+    struct Slot {
+        State state = State::Free;
+        eckit::message::Message message;
+        MetadataRecord metadata;
+        std::exception_ptr error;
+    };
+
+private:  // methods
+
+    void split();
+    void decode();
+
+private:  // members
+
+    Source source_;
+    eckit::message::GetMetadataOptions options_;
+
+    std::vector<Slot> slots_;
+
+    std::mutex mutex_;
+    std::condition_variable splitterCV_;  // a slot was freed
+    std::condition_variable workerCV_;    // a message was split
+    std::condition_variable readerCV_;    // a message was decoded
+
+    size_t split_    = 0;  // messages split so far
+    size_t decoding_ = 0;  // messages handed to workers so far
+    size_t read_     = 0;  // messages returned by next() so far
+    bool end_        = false;
+    bool stopped_    = false;
+
+    std::exception_ptr splitError_;
+
+    std::thread splitter_;
+    std::vector<std::thread> workers_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit
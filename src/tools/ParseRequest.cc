@@ -65,6 +65,7 @@ void ParseRequest::init(const CmdArgs& args) {
     args.get("json", json_);
     args.get("compact", compact_);
     args.get("porcelain", porcelain_);
+    args.get("threads", threads_);
     if (porcelain_) {
         compact_ = true;
     }
@@ -132,7 +133,7 @@ void ParseRequest::process(const eckit::PathName& path) {
         std::cout << "----------> Expanding ... " << std::endl;
     }
 
-    std::vector<MarsRequest> v = expand.expand(p);
+    std::vector<MarsRequest> v = expand.expandBatch(p, threads_);
 
 #ifdef metkit_HAVE_MARS2MARS
     if (grib2_) {
@@ -164,10 +165,7 @@ void ParseRequest::process(const eckit::PathName& path) {
                         continue;
                     }
 
-                    MarsRequest merged{reqs.front()};
-                    for (size_t i = 1; i < reqs.size(); ++i) {
-                        merged.merge(reqs[i]);
-                    }
+                    MarsRequest merged = MarsRequest::merge(reqs.begin(), reqs.end());
                     if (merged.count() == reqs.size()) {  // the set of fields forms a full hypercube - return
                                                           // corresponding merged request
                         converted.push_back(std::move(merged));
@@ -31,6 +31,8 @@ public:
     ParseRequest(int argc, char** argv, bool convertToGrib2 = false) : MetkitTool(argc, argv), grib2_(convertToGrib2) {
         options_.push_back(new SimpleOption<bool>("json", "Format request in json, default = false"));
         options_.push_back(new SimpleOption<bool>("compact", "Compact output, default = false"));
+        options_.push_back(new SimpleOption<size_t>(
+            "threads", "Number of threads used to expand the requests, default = $METKIT_EXPAND_THREADS or all cores"));
     }
 
     virtual ~ParseRequest() {}
@@ -49,7 +51,8 @@ private:  // methods
 
 private:  // members
 
-    bool json_    = false;
-    bool compact_ = false;
-    bool grib2_   = false;
+    bool json_      = false;
+    bool compact_   = false;
+    bool grib2_     = false;
+    size_t threads_ = 0;
 };
@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/log/Log.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/option/SimpleOption.h"
+
+#include "metkit/config/ConfigSnapshot.h"
+#include "metkit/config/LibMetkit.h"
+#include "metkit/tool/MetkitTool.h"
+
+using namespace metkit;
+using namespace eckit;
+using namespace eckit::option;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class CompileMarsLanguageTool : public MetkitTool {
+public:
+
+    CompileMarsLanguageTool(int argc, char** argv) : MetkitTool(argc, argv) {
+        options_.push_back(new SimpleOption<std::string>(
+            "output", "Directory where the snapshots are written, default = next to the YAML files"));
+        options_.push_back(new SimpleOption<bool>("check", "Only report whether the snapshots are fresh"));
+        options_.push_back(new SimpleOption<bool>("force", "Recompile snapshots even when they are fresh"));
+    }
+
+private:  // methods
+
+    void execute(const eckit::option::CmdArgs& args) override;
+
+    void init(const CmdArgs& args) override;
+
+    void usage(const std::string& tool) const override;
+
+    PathName snapshot(const PathName& yaml) const;
+
+private:  // members
+
+    std::string output_;
+    bool check_ = false;
+    bool force_ = false;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompileMarsLanguageTool::init(const CmdArgs& args) {
+    MetkitTool::init(args);
+    args.get("output", output_);
+    args.get("check", check_);
+    args.get("force", force_);
+}
+
+void CompileMarsLanguageTool::usage(const std::string& tool) const {
+    Log::info() << "Usage: " << tool << " [options] [file1.yaml] [file2.yaml] ..." << std::endl
+                << "       Compiles the MARS language YAML files into binary snapshots." << std::endl
+                << "       Without arguments, compiles language, modifiers and parameter tables." << std::endl
+                << std::endl;
+
+    Log::info() << "Examples:" << std::endl
+                << "=========" << std::endl
+                << std::endl
+                << tool << std::endl
+                << tool << " --output=/tmp/metkit-snapshots" << std::endl
+                << tool << " --check" << std::endl
+                << std::endl;
+}
+
+PathName CompileMarsLanguageTool::snapshot(const PathName& yaml) const {
+    if (output_.empty()) {
+        return ConfigSnapshot::snapshotFile(yaml);
+    }
+    return PathName(output_) / (yaml.baseName() + ".bin");
+}
+
+void CompileMarsLanguageTool::execute(const eckit::option::CmdArgs& args) {
+    std::vector<PathName> files;
+    for (size_t i = 0; i < args.count(); i++) {
+        files.emplace_back(args(i));
+    }
+    if (files.empty()) {
+        files = LibMetkit::languageConfigFiles();
+    }
+
+    for (const auto& yaml : files) {
+        PathName out = snapshot(yaml);
+        bool fresh   = ConfigSnapshot::fresh(yaml, out);
+
+        if (check_) {
+            Log::info() << out << (fresh ? " fresh" : " stale") << std::endl;
+            continue;
+        }
+        if (fresh && !force_) {
+            if (!porcelain_) {
+                Log::info() << out << " is up to date" << std::endl;
+            }
+            continue;
+        }
+
+        ConfigSnapshot::compile(yaml, out);
+        if (!porcelain_) {
+            Log::info() << "Compiled " << yaml << " into " << out << std::endl;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    CompileMarsLanguageTool tool(argc, argv);
+    return tool.start();
+}
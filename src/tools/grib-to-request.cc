@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <utility>
@@ -26,8 +27,10 @@
 #include "eckit/utils/StringTools.h"
 
 #include "metkit/hypercube/HyperCube.h"
+#include "metkit/mars/MarsLanguage.h"
 #include "metkit/mars/MarsRequest.h"
 #include "metkit/tool/MetkitTool.h"
+#include "metkit/utils/MetadataPipeline.h"
 
 using namespace metkit;
 using namespace metkit::mars;
@@ -64,7 +67,9 @@ public:
         options_.push_back(new SimpleOption<bool>("one",
                                                   "Merge into one request, potentially describing more data "
                                                   "fields than the ones in the input file, default = false"));
-        options_.push_back(new SimpleOption<bool>("compact", "Merge into a small number of requests, default = false"));
+        options_.push_back(new SimpleOption<bool>(
+            "compact",
+            "Merge into a small number of requests, with from/to/by lists where possible, default = false"));
         options_.push_back(new SimpleOption<bool>("json", "Format request in json, default = false"));
     }
 
@@ -154,24 +159,39 @@ void GribToRequestTool::execute(const eckit::option::CmdArgs& args) {
 
     eckit::message::Reader reader(dh, false);
     eckit::message::Message msg;
+    MetadataRecord metadata;
+
+    // Messages are decoded concurrently, and come back in order
+    MetadataPipeline pipeline(reader);
 
     std::vector<MarsRequest> requests;
+    std::optional<MarsRequest::Merger> merger;  // merges all the requests in one, in linear time
 
-    while ((msg = reader.next())) {
+    while (pipeline.next(msg, metadata)) {
         MarsRequest r(verb_);
         MarsRequestSetter setter(r);
 
-        msg.getMetadata(setter);
+        metadata.gather(setter);
 
-        if (one_ and requests.size()) {
-            requests.back().merge(r);
+        if (!one_) {
+            requests.push_back(std::move(r));
+        }
+        else if (merger) {
+            merger->add(r);
         }
         else {
-            requests.push_back(r);
+            merger.emplace(r);
         }
     }
 
+    if (merger) {
+        requests.push_back(std::move(*merger).request());
+    }
+
     if (compact_ && requests.size() > 1) {
+        // lists of dates, steps, levels, ... are written as from/to/by lists where possible
+        const MarsLanguage& language = MarsLanguage::instance(verb_);
+
         std::map<std::set<std::string>, std::vector<MarsRequest>> coherentRequests;
 
         // split the requests into groups of requests with the same set of metadata (but potentially different values)
@@ -191,13 +211,10 @@ void GribToRequestTool::execute(const eckit::option::CmdArgs& args) {
                 continue;
             }
 
-            MarsRequest merged{reqs.front()};
-            for (size_t i = 1; i < reqs.size(); ++i) {
-                merged.merge(reqs[i]);
-            }
+            MarsRequest merged = MarsRequest::merge(reqs.begin(), reqs.end());
             if (merged.count() ==
                 reqs.size()) {  // the set of fields forms a full hypercube - return corresponding merged request
-                requests.push_back(std::move(merged));
+                requests.push_back(language.compact(merged));
                 continue;
             }
 
@@ -206,7 +223,7 @@ void GribToRequestTool::execute(const eckit::option::CmdArgs& args) {
             for (const auto& r : reqs) {
                 h.clear(r);
             }
-            for (const auto& r : h.requests()) {
+            for (const auto& r : h.requests(true)) {
                 requests.push_back(r);
             }
         }
@@ -0,0 +1,167 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   hypercube-benchmark.cc
+/// @date   Oct 2026
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eckit/log/Log.h"
+#include "eckit/log/Timer.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/option/SimpleOption.h"
+
+#include "metkit/hypercube/HyperCube.h"
+#include "metkit/hypercube/HyperCubeFile.h"
+#include "metkit/mars/MarsRequest.h"
+#include "metkit/tool/MetkitTool.h"
+
+using namespace metkit;
+using namespace eckit;
+using namespace eckit::option;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Gives access to the fields by index, so that the benchmark does not measure building requests
+class BenchmarkCube : public hypercube::HyperCube {
+public:
+
+    using HyperCube::clear;
+    using HyperCube::HyperCube;
+};
+
+std::vector<std::string> numbers(size_t n) {
+    std::vector<std::string> v;
+    v.reserve(n);
+    for (size_t i = 1; i <= n; ++i) {
+        v.push_back(std::to_string(i));
+    }
+    return v;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class HyperCubeBenchmarkTool : public MetkitTool {
+public:
+
+    HyperCubeBenchmarkTool(int argc, char** argv) : MetkitTool(argc, argv) {
+        options_.push_back(new SimpleOption<long>("fields", "Number of fields in the cube, default = 1000000"));
+        options_.push_back(
+            new SimpleOption<double>("archived", "Fraction of the fields cleared from the cube, default = 0.99"));
+        options_.push_back(new SimpleOption<std::string>(
+            "pattern", "Which fields are cleared: random or ordered (in cube order), default = random"));
+        options_.push_back(new SimpleOption<std::string>("file", "Also save the cube to this file and reopen it"));
+    }
+
+private:  // methods
+
+    void init(const CmdArgs& args) override {
+        args.get("fields", fields_);
+        args.get("archived", archived_);
+        args.get("pattern", pattern_);
+        args.get("file", file_);
+    }
+
+    void execute(const CmdArgs& args) override;
+
+    void usage(const std::string& tool) const override {
+        Log::info() << "Usage: " << tool << " [--fields=N] [--archived=F] [--pattern=random|ordered] [--file=path]"
+                    << std::endl
+                    << std::endl
+                    << "Examples:" << std::endl
+                    << "=========" << std::endl
+                    << std::endl
+                    << tool << " --fields=100000000 --archived=0.999" << std::endl
+                    << std::endl;
+    }
+
+private:  // members
+
+    long fields_     = 1000000;
+    double archived_ = 0.99;
+    std::string pattern_{"random"};
+    std::string file_;
+};
+
+void HyperCubeBenchmarkTool::execute(const CmdArgs&) {
+
+    // param x levelist x number x step fill 10^5 fields, dates make up the rest
+    size_t dates = std::max<long>(1, (fields_ + 99999) / 100000);
+
+    mars::MarsRequest request("retrieve");
+    request.values("date", numbers(dates));
+    request.values("step", numbers(100));
+    request.values("number", numbers(10));
+    request.values("levelist", numbers(10));
+    request.values("param", numbers(100));
+
+    Timer timer("hypercube-benchmark");
+
+    BenchmarkCube cube(request);
+    Log::info() << "Cube of " << cube.size() << " fields built in " << timer.elapsed() << "s" << std::endl;
+
+    timer.start();
+    std::mt19937_64 random(42);
+    std::bernoulli_distribution arrived(archived_);
+    size_t last = cube.size() * archived_;
+    for (size_t i = 0; i < cube.size(); ++i) {
+        if (pattern_ == "ordered" ? i < last : arrived(random)) {
+            cube.clear(static_cast<int>(i));
+        }
+    }
+    Log::info() << cube.size() - cube.countVacant() << " fields cleared in " << timer.elapsed() << "s" << std::endl;
+
+    if (cube.countVacant() > 0) {
+        timer.start();
+        size_t lookups = 100000;
+        for (size_t i = 0; i < lookups; ++i) {
+            cube.fieldOrdinal(cube.vacantField((i * 7919) % cube.countVacant()));
+        }
+        Log::info() << lookups << " vacant field and ordinal lookups in " << timer.elapsed() << "s" << std::endl;
+    }
+
+    timer.start();
+    std::vector<mars::MarsRequest> vacant = cube.vacantRequests();
+    Log::info() << vacant.size() << " requests for " << cube.countVacant() << " vacant fields in " << timer.elapsed()
+                << "s" << std::endl;
+
+    timer.start();
+    std::vector<mars::MarsRequest> requests = cube.requests();
+    Log::info() << requests.size() << " requests for the cleared fields in " << timer.elapsed() << "s" << std::endl;
+
+    if (!file_.empty()) {
+        timer.start();
+        cube.save(file_);
+        Log::info() << "Cube saved to " << file_ << " in " << timer.elapsed() << "s" << std::endl;
+
+        timer.start();
+        hypercube::HyperCubeFile file(file_);
+        Log::info() << "Cube file of " << file.countVacant() << " vacant fields opened in " << timer.elapsed() << "s"
+                    << std::endl;
+
+        timer.start();
+        hypercube::HyperCube reopened(file);
+        Log::info() << "Cube reopened in " << timer.elapsed() << "s" << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    HyperCubeBenchmarkTool tool(argc, argv);
+    return tool.start();
+}
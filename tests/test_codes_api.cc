@@ -154,6 +154,73 @@ CASE("Test setting values") {
     EXPECT_EQUAL(count, numberValues);
 }
 
+CASE("Test getting values into a buffer") {
+    using namespace codes;
+
+    auto handle = codesHandleFromSample("GRIB2");
+
+    size_t numberValues = handle->size("values");
+
+    std::vector<double> newVals;
+    for (size_t i = 0; i < numberValues; ++i) {
+        newVals.push_back((double)(i % 100));
+    }
+    handle->set("values", newVals);
+
+    std::vector<double> doubles(numberValues);
+    EXPECT_EQUAL(handle->getDoubleArray("values", doubles.data(), doubles.size()), numberValues);
+    EXPECT_EQUAL(doubles, newVals);
+    EXPECT_EQUAL(doubles, handle->getDoubleArray("values"));
+
+    std::vector<float> floats(numberValues);
+    EXPECT_EQUAL(handle->getFloatArray("values", floats.data(), floats.size()), numberValues);
+    EXPECT_EQUAL(floats, handle->getFloatArray("values"));
+    for (size_t i = 0; i < numberValues; ++i) {
+        EXPECT_EQUAL(floats[i], float(newVals[i]));
+    }
+
+    std::vector<double> tooSmall(numberValues - 1);
+    EXPECT_THROWS_AS(handle->getDoubleArray("values", tooSmall.data(), tooSmall.size()), CodesException);
+}
+
+CASE("Test getting keys through a KeySet") {
+    using namespace codes;
+
+    auto handle = codesHandleFromSample("GRIB2");
+
+    const KeySet keys{{"shortName", NativeType::String},
+                      {"edition", NativeType::Long},
+                      {"latitudeOfFirstGridPointInDegrees", NativeType::Double},
+                      {"undefinedKey", NativeType::Long, OnMissing::Skip},
+                      {"gridType", NativeType::String}};
+
+    EXPECT_EQUAL(keys.size(), 5);
+    EXPECT_EQUAL(keys.at("gridType"), 4);
+    EXPECT(!keys.index("paramId"));
+
+    KeyRecord record(keys);
+    handle->getKeys(keys, record);
+
+    EXPECT_EQUAL(record.getString(0), handle->getString("shortName"));
+    EXPECT_EQUAL(record.getLong(1), 2);
+    EXPECT_EQUAL(record.getDouble(2), handle->getDouble("latitudeOfFirstGridPointInDegrees"));
+    EXPECT(!record.has(3));
+    EXPECT_THROWS_AS(record.getLong(3), eckit::UserError);
+    EXPECT_EQUAL(std::get<std::string>(record.get(4)), handle->getString("gridType"));
+
+    // Records are reused from one message to the next
+    handle->set("shortName", std::string("2t"));
+    handle->getKeys(keys, record);
+    EXPECT_EQUAL(record.getString(0), handle->getString("shortName"));
+
+    const KeySet required{{"edition", NativeType::Long}, {"undefinedKey", NativeType::Long}};
+    KeyRecord incomplete(required);
+    EXPECT_THROWS_AS(handle->getKeys(required, incomplete), CodesException);
+
+    EXPECT_THROWS_AS(KeySet({{"edition", NativeType::Long}, {"edition", NativeType::String}}), eckit::UserError);
+    EXPECT_THROWS_AS(KeySet({{"bitmap", NativeType::Bytes}}), eckit::UserError);
+}
+
 CASE("Test load and iterate mars keys") {
     using namespace codes;
 
@@ -11,17 +11,27 @@
 /// @date   Nov 2022
 /// @author Philipp Geier
 
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <string>
 #include <vector>
 
 #include "eckit/config/LocalConfiguration.h"
+#include "eckit/filesystem/PathName.h"
 #include "eckit/io/FileHandle.h"
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/message/Message.h"
 #include "eckit/message/Reader.h"
 #include "eckit/testing/Test.h"
 
+#include "metkit/codes/MappedCodesReader.h"
+#include "metkit/codes/api/CodesAPI.h"
+#include "metkit/codes/api/CodesTypes.h"
+#include "metkit/utils/MetadataPipeline.h"
+
 namespace metkit::codes::test {
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -549,6 +559,325 @@ CASE("test levelist Native") {
     EXPECT(!msg);
 }
 
+CASE("test mapped reader splits as the codes splitter") {
+    for (const char* path : {"pl.grib", "sol.grib"}) {
+        eckit::FileHandle f(path);
+        eckit::message::Reader reader(f);
+        MappedCodesReader mapped(path);
+
+        eckit::message::Message msg;
+        while ((msg = reader.next())) {
+            eckit::message::Message other = mapped.next();
+            EXPECT(other);
+            EXPECT_EQUAL(other.offset(), msg.offset());
+            EXPECT_EQUAL(other.length(), msg.length());
+            EXPECT_EQUAL(other.getString("levelist"), msg.getString("levelist"));
+            EXPECT_EQUAL(other.getLong("paramId"), msg.getLong("paramId"));
+        }
+        EXPECT(!mapped.next());
+    }
+}
+
+CASE("test mapped reader messages can be transformed") {
+    MappedCodesReader mapped("pl.grib");
+    eckit::message::Message msg = mapped.next();
+    EXPECT(msg);
+    long date = msg.getLong("dataDate");
+
+    // the message is copied out of the read-only mapping before it is modified
+    msg.transform(eckit::OrderedStringDict{{"dataDate", "20000101"}});
+    EXPECT_EQUAL(msg.getLong("dataDate"), 20000101);
+
+    MappedCodesReader again("pl.grib");
+    EXPECT_EQUAL(again.next().getLong("dataDate"), date);
+}
+
+CASE("test mapped reader skips bytes between messages") {
+    auto read = [](const char* path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+    const std::string pl  = read("pl.grib");
+    const std::string sol = read("sol.grib");
+    const std::string junk(13, 'x');
+
+    {
+        std::ofstream out("mapped_reader.grib", std::ios::binary);
+        out << junk << sol << junk << pl << "GRIB";
+    }
+
+    MappedCodesReader mapped("mapped_reader.grib");
+    EXPECT_EQUAL(mapped.size(), 2 * junk.size() + sol.size() + pl.size() + 4);
+
+    eckit::Offset offset;
+    std::vector<eckit::Offset> offsets;
+    for (size_t i = 0; i < 10; ++i) {
+        Span<const uint8_t> bytes = mapped.nextBytes(offset);
+        EXPECT(bytes.size() > 0);
+        EXPECT_EQUAL(std::string(reinterpret_cast<const char*>(bytes.data()), 4), "GRIB");
+        offsets.push_back(offset);
+    }
+    EXPECT_EQUAL(offsets[0], eckit::Offset(junk.size()));
+    EXPECT_EQUAL(offsets[4], eckit::Offset(2 * junk.size() + sol.size()));
+
+    // The trailing "GRIB" is not a whole message
+    EXPECT_THROWS_AS(mapped.nextBytes(offset), CodesWrongLength);
+    EXPECT_EQUAL(mapped.nextBytes(offset).size(), 0);
+
+    EXPECT_EQUAL(MappedCodesReader::messageLength(reinterpret_cast<const uint8_t*>(pl.data()), pl.size()),
+                 pl.size() / 6);
+    EXPECT_EQUAL(MappedCodesReader::messageLength(reinterpret_cast<const uint8_t*>(pl.data()), pl.size() / 6 - 1), 0);
+
+    eckit::PathName("mapped_reader.grib").unlink();
+}
+
+CASE("test mapped reader message lengths") {
+    auto put = [](std::vector<uint8_t>& m, size_t at, uint64_t value, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            m[at + i] = uint8_t(value >> (8 * (n - 1 - i)));
+        }
+    };
+    // A message of the given length, starting with magic and ending with "7777"
+    auto message = [](const char* magic, size_t length) {
+        std::vector<uint8_t> m(length, 0);
+        std::memcpy(m.data(), magic, 4);
+        std::memcpy(m.data() + length - 4, "7777", 4);
+        return m;
+    };
+    auto length = [](const std::vector<uint8_t>& m) { return MappedCodesReader::messageLength(m.data(), m.size()); };
+
+    // GRIB 1 of more than 8MB, with a section 4 shorter than 120 bytes: the length is counted in units of 120 bytes
+    {
+        const size_t units = 70000;
+        const size_t sec4  = 50;
+        std::vector<uint8_t> m = message("GRIB", units * 120 - sec4 + 4);
+        m[7]                   = 1;
+        put(m, 4, 0x800000 | units, 3);
+        put(m, 8, 28, 3);  // section 1, no sections 2 nor 3
+        put(m, 8 + 28, sec4, 3);
+        EXPECT_EQUAL(length(m), m.size());
+    }
+
+    // GRIB 1 of more than 8MB, with a longer section 4: the 24 bits are the length
+    {
+        std::vector<uint8_t> m = message("GRIB", 9000000);
+        m[7]                   = 1;
+        put(m, 4, m.size(), 3);
+        put(m, 8, 28, 3);
+        put(m, 8 + 28, m.size() - 8 - 28 - 4, 3);
+        EXPECT_EQUAL(length(m), m.size());
+    }
+
+    // GRIB 2, with a 64-bit length
+    {
+        std::vector<uint8_t> m = message("GRIB", 20000000);
+        m[7]                   = 2;
+        put(m, 8, m.size(), 8);
+        EXPECT_EQUAL(length(m), m.size());
+
+        m.pop_back();
+        EXPECT_EQUAL(length(m), 0);
+    }
+
+    // BUFR edition 4, and edition 1 which does not hold its length
+    {
+        std::vector<uint8_t> m = message("BUFR", 200);
+        m[7]                   = 4;
+        put(m, 4, m.size(), 3);
+        EXPECT_EQUAL(length(m), m.size());
+
+        m[7] = 1;
+        EXPECT_EQUAL(length(m), 0);
+    }
+
+    // BUDG and TIDE: the magic, sections 1 and 4, and "7777"
+    for (const char* magic : {"BUDG", "TIDE"}) {
+        std::vector<uint8_t> m = message(magic, 4 + 20 + 10 + 4);
+        put(m, 4, 20, 3);
+        put(m, 4 + 20, 10, 3);
+        EXPECT_EQUAL(length(m), m.size());
+
+        m[m.size() - 1] = 0;
+        EXPECT_EQUAL(length(m), 0);
+    }
+}
+
+CASE("test metadata pipeline returns messages in order") {
+    eckit::message::GetMetadataOptions mdOpts{};
+    mdOpts.valueRepresentation = eckit::message::ValueRepresentation::String;
+
+    std::vector<std::string> expect{"0", "0.02", "0.2", "2", "20", "200"};
+
+    for (size_t threads : {1, 3}) {
+        eckit::FileHandle f("pl.grib");
+        eckit::message::Reader reader(f);
+
+        MetadataPipeline pipeline(reader, mdOpts, threads, 2);
+        EXPECT_EQUAL(pipeline.threads(), threads);
+
+        eckit::message::Message msg;
+        MetadataRecord metadata;
+        for (size_t i = 0; i < expect.size(); ++i) {
+            EXPECT(pipeline.next(msg, metadata));
+            EXPECT(msg);
+
+            MetadataSetter md;
+            eckit::message::TypedSetter<MetadataSetter> gatherer{md};
+            metadata.gather(gatherer);
+            { MD_EXPECT_STRING(md, "levelist", expect[i]); }
+        }
+        EXPECT(!pipeline.next(msg, metadata));
+    }
+
+    // One worker by default
+    {
+        eckit::FileHandle f("pl.grib");
+        eckit::message::Reader reader(f);
+        EXPECT_EQUAL(MetadataPipeline(reader, mdOpts).threads(), 1);
+    }
+
+    // Stopping before the end of the input: with one message in flight, at most two are read
+    MappedCodesReader mapped("pl.grib");
+    size_t read = 0;
+    MetadataPipeline pipeline(
+        [&mapped, &read] {
+            ++read;
+            return mapped.next();
+        },
+        mdOpts, 2, 1);
+
+    eckit::message::Message msg;
+    MetadataRecord metadata;
+    EXPECT(pipeline.next(msg, metadata));
+
+    MetadataSetter md;
+    eckit::message::TypedSetter<MetadataSetter> gatherer{md};
+    metadata.gather(gatherer);
+    { MD_EXPECT_STRING(md, "levelist", expect[0]); }
+
+    pipeline.stop();
+    EXPECT(!pipeline.next(msg, metadata));
+    EXPECT(!pipeline.next(msg, metadata));
+    EXPECT(read <= 2);
+
+    // the input is left where the pipeline stopped
+    size_t left = 0;
+    while (mapped.next()) {
+        ++left;
+    }
+    EXPECT_EQUAL(read + left, expect.size());
+}
+
+CASE("test metadata read from keys cached by signature") {
+    // All messages of pl.grib share a signature: the first fills the cache, the others are read from it with the same
+    // keys and types
+    for (auto representation : {eckit::message::ValueRepresentation::String,
+                                eckit::message::ValueRepresentation::Native}) {
+        eckit::message::GetMetadataOptions mdOpts{};
+        mdOpts.valueRepresentation = representation;
+
+        eckit::FileHandle f("pl.grib");
+        eckit::message::Reader reader(f);
+
+        std::vector<MetadataRecord> records;
+        eckit::message::Message msg;
+        while ((msg = reader.next())) {
+            records.emplace_back();
+            msg.getMetadata(records.back(), mdOpts);
+
+            MetadataRecord again;
+            msg.getMetadata(again, mdOpts);
+            EXPECT(again.values() == records.back().values());
+        }
+        EXPECT_EQUAL(records.size(), 6);
+
+        for (const auto& record : records) {
+            EXPECT_EQUAL(record.values().size(), records.front().values().size());
+            for (size_t i = 0; i < record.values().size(); ++i) {
+                EXPECT_EQUAL(record.values()[i].first, records.front().values()[i].first);
+                EXPECT_EQUAL(record.values()[i].second.index(), records.front().values()[i].second.index());
+            }
+        }
+
+        MetadataSetter md;
+        eckit::message::TypedSetter<MetadataSetter> gatherer{md};
+        records.back().gather(gatherer);
+        if (representation == eckit::message::ValueRepresentation::String) {
+            MD_EXPECT_STRING(md, "levelist", "200");
+        }
+        else {
+            MD_EXPECT_LONG(md, "levelist", 200);
+        }
+    }
+}
+
+CASE("test metadata read from keys cached by signature matches the namespace") {
+    // Messages of two signatures, interleaved, each read twice. This test also runs with the cache disabled
+    // ($METKIT_GRIB_DECODER_CACHE_KEYS=0), where all messages are read by iterating the namespace
+    auto read = [](const char* path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+    const std::string pl  = read("pl.grib");
+    const std::string sol = read("sol.grib");
+    {
+        std::ofstream out("cached_keys.grib", std::ios::binary);
+        out << sol << pl << sol << pl;
+    }
+
+    // The values of the scalar keys of the mars namespace, read by iterating it
+    auto iterated = [](const eckit::message::Message& msg) {
+        auto h = codesHandleFromMessage({static_cast<const uint8_t*>(msg.data()), msg.length()});
+        std::map<std::string, std::string> values;
+        for (const auto& k : h->keys(namespaces::mars)) {
+            std::string name = k.name();
+            if (name[0] != '_' && name != "levelist" && h->size(name) == 1) {
+                values[name] = k.getString();
+            }
+        }
+        values["param"] = h->getString("paramId");
+        return values;
+    };
+
+    eckit::message::GetMetadataOptions stringOpts{};
+    stringOpts.valueRepresentation = eckit::message::ValueRepresentation::String;
+    eckit::message::GetMetadataOptions nativeOpts{};
+    nativeOpts.valueRepresentation = eckit::message::ValueRepresentation::Native;
+
+    eckit::FileHandle f("cached_keys.grib");
+    eckit::message::Reader reader(f);
+
+    size_t count = 0;
+    eckit::message::Message msg;
+    while ((msg = reader.next())) {
+        ++count;
+        const auto expected = iterated(msg);
+
+        for (size_t pass = 0; pass < 2; ++pass) {
+            MetadataRecord record;
+            msg.getMetadata(record, stringOpts);
+
+            std::map<std::string, std::string> values;
+            for (const auto& [name, value] : record.values()) {
+                if (name != "levelist") {
+                    values[name] = std::get<std::string>(value);
+                }
+            }
+            EXPECT(values == expected);
+
+            MetadataRecord native;
+            msg.getMetadata(native, nativeOpts);
+            EXPECT_EQUAL(native.values().size(), record.values().size());
+            for (size_t i = 0; i < native.values().size() && i < record.values().size(); ++i) {
+                EXPECT_EQUAL(native.values()[i].first, record.values()[i].first);
+            }
+        }
+    }
+    EXPECT_EQUAL(count, 20);
+
+    eckit::PathName("cached_keys.grib").unlink();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace metkit::codes::test
@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   test_config_snapshot.cc
+/// @date   Oct 2026
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/parser/YAMLParser.h"
+#include "eckit/testing/Test.h"
+
+#include "metkit/config/ConfigSnapshot.h"
+#include "metkit/config/LibMetkit.h"
+
+namespace metkit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("snapshot round trip") {
+    eckit::PathName dir("test_config_snapshot.d");
+    dir.mkdir();
+
+    for (const auto& yaml : LibMetkit::languageConfigFiles()) {
+        eckit::PathName snapshot = dir / (yaml.baseName() + ".bin");
+        if (snapshot.exists()) {
+            snapshot.unlink();
+        }
+
+        EXPECT(!ConfigSnapshot::fresh(yaml, snapshot));
+        ConfigSnapshot::compile(yaml, snapshot);
+        EXPECT(ConfigSnapshot::fresh(yaml, snapshot));
+
+        eckit::Value expected = eckit::YAMLParser::decodeFile(yaml);
+        eckit::Value loaded   = ConfigSnapshot::load(snapshot);
+        EXPECT(loaded == expected);
+
+        snapshot.unlink();
+    }
+}
+
+CASE("stale snapshot is not fresh") {
+    eckit::PathName dir("test_config_snapshot.d");
+    dir.mkdir();
+
+    eckit::PathName snapshot = dir / "shortname-context.yaml.bin";
+    ConfigSnapshot::compile(LibMetkit::shortnameContextYamlFile(), snapshot);
+
+    EXPECT(ConfigSnapshot::fresh(LibMetkit::shortnameContextYamlFile(), snapshot));
+    EXPECT(!ConfigSnapshot::fresh(LibMetkit::paramYamlFile(), snapshot));
+
+    snapshot.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::test
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -45,6 +45,44 @@ CASE("Context match") {
     EXPECT(c.matches(r));
 }
 
+CASE("Context cache") {
+
+    std::set<std::string> cc{"od"};
+    std::set<std::string> tt{"fc"};
+
+    Context c1;
+    c1.add(std::make_unique<Include>("class", cc));
+    c1.add(std::make_unique<Include>("type", tt));
+
+    Context c2;
+    c2.add(std::make_unique<Include>("class", cc));
+    c2.add(std::make_unique<Undef>("levelist"));
+
+    MarsRequest r("retrieve");
+    r.setValue("class", "od");
+    r.setValue("type", "fc");
+
+    ContextCache cache;
+    EXPECT(c1.matches(r, cache));
+    EXPECT(c2.matches(r, cache));
+
+    // the cached results are kept until the keyword they depend on is invalidated
+    r.setValue("levelist", "500");
+    EXPECT(c2.matches(r, cache));
+    cache.invalidate(ContextRule::keyId("levelist"));
+    EXPECT(!c2.matches(r, cache));
+    EXPECT(!c2.matches(r));
+
+    r.setValue("class", "rd");
+    EXPECT(c1.matches(r, cache));
+    cache.invalidate(ContextRule::keyId("class"));
+    EXPECT(!c1.matches(r, cache));
+
+    cache.clear();
+    r.setValue("class", "od");
+    EXPECT(c1.matches(r, cache));
+}
+
 
 //-----------------------------------------------------------------------------
 
@@ -13,8 +13,11 @@
 /// @author Florian Rathgeber
 /// @author Emanuele Danovaro
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <thread>
+#include <tuple>
 #include <utility>
 
 #include "eckit/filesystem/LocalPathName.h"
@@ -1365,6 +1368,350 @@ CASE("test_metkit_disseminate_params-static") {
     expand(text, expected, false);
 }
 
+CASE("test_metkit_expand_shared_language") {
+    const std::string text =
+        "ret,class=od,date=20240304,time=0,type=fc,levtype=pl,levelist=500/850,step=0/to/12/by/6,param=t\n"
+        "ret,param=z\n"
+        "ret,levelist=off,levtype=sfc,param=2t";
+
+    std::vector<std::string> expected;
+    {
+        std::istringstream in(text);
+        MarsParser parser(in);
+        MarsExpansion expand(true);
+        for (const auto& r : expand.expand(parser.parse())) {
+            expected.push_back(r.asString());
+        }
+    }
+    EXPECT_EQUAL(expected.size(), 3);
+
+    std::istringstream in(text);
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+
+    const MarsLanguage& language = MarsLanguage::instance("retrieve");
+    EXPECT(&language == &MarsLanguage::instance("ret"));
+
+    constexpr size_t nThreads = 8;
+    std::vector<std::vector<std::string>> results(nThreads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < nThreads; ++i) {
+        threads.emplace_back([&, i] {
+            for (size_t n = 0; n < 20; ++n) {
+                MarsExpandContext context;
+                results[i].clear();
+                for (const auto& r : requests) {
+                    results[i].push_back(language.expand(r, context, true, false).asString());
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (const auto& r : results) {
+        EXPECT_EQUAL(r, expected);
+    }
+}
+
+CASE("test_metkit_expand_batch") {
+    const std::string text =
+        "ret,class=od,date=20240304,time=0,type=fc,levtype=pl,levelist=500/850,step=0/to/12/by/6,param=t\n"
+        "ret,param=z\n"
+        "ret,levelist=off,levtype=sfc,param=2t\n"
+        "ret,date=-1,time=12,step=24\n"
+        "list,class=rd,expver=abcd\n"
+        "ret,type=an,step=0";
+
+    std::istringstream in(text);
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+
+    std::vector<MarsRequest> expected = MarsExpansion(true).expand(requests);
+    EXPECT_EQUAL(expected.size(), requests.size());
+
+    for (size_t threads : {1, 2, 4, 16}) {
+        std::vector<MarsRequest> batch = MarsExpansion(true).expandBatch(requests, threads);
+        EXPECT_EQUAL(batch.size(), expected.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            EXPECT_EQUAL(batch[i].asString(), expected[i].asString());
+        }
+    }
+
+    // inheritance carries over from one batch to the next, and to and from single requests
+    MarsExpansion expand(true);
+    std::vector<MarsRequest> first  = expand.expandBatch({requests[0]});
+    std::vector<MarsRequest> second = expand.expandBatch({requests[1]});
+    EXPECT_EQUAL(first[0].asString(), expected[0].asString());
+    EXPECT_EQUAL(second[0].asString(), expected[1].asString());
+    EXPECT_EQUAL(expand.expand(requests[2]).asString(), expected[2].asString());
+    EXPECT_EQUAL(expand.expandBatch({requests[3]})[0].asString(), expected[3].asString());
+}
+
+CASE("test_metkit_expand_batch_inherits_defaults") {
+    // the defaulted levelist of levtype=pl and ml, and the defaulted class, stream, expver, ... are inherited
+    const std::string text =
+        "ret,date=20240304,levtype=pl,param=t\n"
+        "ret,param=z\n"
+        "ret,levtype=ml,param=130\n"
+        "ret,param=131,step=6\n"
+        "ret,type=an,levtype=sfc,param=2t\n"
+        "ret,levtype=pl,param=r\n"
+        "ret,levelist=off,param=q";
+
+    std::istringstream in(text);
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+
+    MarsExpansion sequential(true);
+    sequential.cache(nullptr);
+    std::vector<MarsRequest> expected;
+    for (const auto& r : requests) {
+        expected.push_back(sequential.expand(r));
+    }
+    EXPECT(expected[1].has("levelist"));
+    EXPECT_EQUAL(expected[1].values("levelist"), expected[0].values("levelist"));
+
+    for (size_t threads : {1, 3, 8}) {
+        MarsExpansion batch(true);
+        batch.cache(nullptr);
+        std::vector<MarsRequest> result = batch.expandBatch(requests, threads);
+        EXPECT_EQUAL(result.size(), expected.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            EXPECT_EQUAL(result[i].asString(), expected[i].asString());
+        }
+    }
+}
+
+CASE("test_metkit_expand_batch_error") {
+    std::istringstream in("ret,param=t\nret,class=notaclass\nret,levtype=notalevtype");
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+
+    try {
+        MarsExpansion(true).expandBatch(requests, 4);
+        EXPECT(false);
+    }
+    catch (const eckit::UserError& e) {
+        EXPECT(std::string(e.what()).find("notaclass") != std::string::npos);
+    }
+}
+
+CASE("test_metkit_expand_batch_error_in_large_batch") {
+    // one failing request in the middle: the requests before it still inherit in order, and its error is reported
+    std::string text = "ret,class=od,date=20240304,type=fc,levtype=pl,levelist=500,param=t\n";
+    for (size_t i = 1; i < 400; ++i) {
+        text += i == 200 ? "ret,levtype=notalevtype\n" : "ret,step=" + std::to_string(i % 48) + "\n";
+    }
+
+    std::istringstream in(text);
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+    EXPECT_EQUAL(requests.size(), 400);
+
+    MarsExpansion sequential(true);
+    sequential.cache(nullptr);
+    for (size_t i = 0; i < 200; ++i) {
+        sequential.expand(requests[i]);
+    }
+    const std::string next = sequential.expand(requests[1]).asString();
+
+    for (size_t threads : {2, 8, 32}) {
+        for (size_t run = 0; run < 5; ++run) {
+            MarsExpansion batch(true);
+            batch.cache(nullptr);
+            try {
+                batch.expandBatch(requests, threads);
+                EXPECT(false);
+            }
+            catch (const eckit::UserError& e) {
+                EXPECT(std::string(e.what()).find("notalevtype") != std::string::npos);
+            }
+            EXPECT_EQUAL(batch.expand(requests[1]).asString(), next);
+        }
+    }
+}
+
+CASE("test_metkit_expand_cache") {
+    std::istringstream in("ret,date=20250101,param=t,levelist=500\nret,param=z\nret,param=z,levelist=off\nret,param=z");
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+
+    MarsExpansion uncached(true);
+    uncached.cache(nullptr);
+    const std::vector<MarsRequest> expected = uncached.expand(requests);
+
+    auto cache = std::make_shared<MarsExpansionCache>(16);
+
+    for (size_t i = 0; i < 3; ++i) {
+        // the inherited values are part of the key, the two "ret,param=z" are different entries
+        MarsExpansion expand(true);
+        expand.cache(cache);
+        std::vector<MarsRequest> result = expand.expand(requests);
+        EXPECT_EQUAL(result.size(), expected.size());
+        for (size_t j = 0; j < result.size(); ++j) {
+            EXPECT_EQUAL(result[j].asString(), expected[j].asString());
+        }
+    }
+    EXPECT_EQUAL(cache->size(), 4);
+    EXPECT_EQUAL(cache->misses(), 4);
+    EXPECT_EQUAL(cache->hits(), 8);
+
+    // least recently used entries are evicted first
+    auto small = std::make_shared<MarsExpansionCache>(2);
+    MarsExpansion expand(false);
+    expand.cache(small);
+    expand.expand(requests[0]);
+    expand.expand(requests[1]);
+    expand.expand(requests[0]);
+    expand.expand(requests[2]);
+    EXPECT_EQUAL(small->size(), 2);
+    EXPECT_EQUAL(small->hits(), 1);
+    expand.expand(requests[0]);
+    EXPECT_EQUAL(small->hits(), 2);
+    expand.expand(requests[1]);
+    EXPECT_EQUAL(small->hits(), 2);
+
+    // concurrent use
+    std::vector<MarsParsedRequest> batch;
+    for (size_t i = 0; i < 50; ++i) {
+        batch.insert(batch.end(), requests.begin(), requests.end());
+    }
+    MarsExpansion batchExpand(true);
+    batchExpand.cache(std::make_shared<MarsExpansionCache>(16));
+    std::vector<MarsRequest> result = batchExpand.expandBatch(batch, 8);
+    for (size_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQUAL(result[i].asString(), expected[i % expected.size()].asString());
+    }
+    EXPECT_EQUAL(batchExpand.cache()->hits() + batchExpand.cache()->misses(), batch.size());
+}
+
+CASE("test_metkit_expand_cache_key") {
+    std::istringstream in(
+        "ret,date=20250101,param=t,levelist=500\nret,levelist=500,param=t,date=20250101\nret,date=20250101,param=t\n"
+        "ret,par=t,param=z\nret,param=z,par=t");
+    MarsParser parser(in);
+    const std::vector<MarsParsedRequest> requests = parser.parse();
+
+    auto key = [](const MarsRequest& r, bool strict = false) { return MarsExpansionCache::key(r, nullptr, strict); };
+
+    // the order of the keywords does not matter, their values do
+    EXPECT_EQUAL(key(requests[0]), key(requests[1]));
+    EXPECT(key(requests[0]) != key(requests[2]));
+    EXPECT(key(requests[0]) != key(requests[0], true));
+
+    // unless several of them are abbreviations of the same keyword, of which the first one is kept
+    EXPECT(key(requests[3]) != key(requests[4]));
+
+    MarsExpansion expand(false);
+    expand.cache(std::make_shared<MarsExpansionCache>(16));
+    MarsRequest first  = expand.expand(requests[0]);
+    MarsRequest second = expand.expand(requests[1]);
+    EXPECT_EQUAL(second.asString(), first.asString());
+    EXPECT_EQUAL(expand.cache()->hits(), 1);
+    expand.expand(requests[2]);
+    EXPECT_EQUAL(expand.cache()->misses(), 2);
+}
+
+CASE("test_metkit_expand_range") {
+    const MarsLanguage& language = MarsLanguage::instance("retrieve");
+
+    for (const auto& [key, values] : std::vector<std::pair<std::string, std::vector<std::string>>>{
+             {"date", {"19790101", "to", "20251231"}},
+             {"date", {"20251231", "to", "19790101", "by", "-7"}},
+             {"step", {"0", "to", "8760", "by", "1"}},
+             {"step", {"40m", "to", "2", "by", "10m"}},
+             {"time", {"1", "to", "3h", "by", "30m"}},
+             {"levelist", {"1", "to", "137"}}}) {
+        const Type* t = language.type(key);
+
+        std::vector<std::string> expanded = values;
+        t->expand(expanded);
+
+        std::shared_ptr<const ValueRange> range = t->range(values);
+        EXPECT(range);
+        EXPECT_EQUAL(range->size(), expanded.size());
+        EXPECT_EQUAL(range->values(), expanded);
+    }
+
+    // only a single from/to/by list is kept unexpanded
+    EXPECT(!language.type("step")->range({"0", "to", "24", "by", "3", "36"}));
+    EXPECT(!language.type("param")->range({"129", "to", "130"}));
+    EXPECT_THROWS_AS(language.type("step")->range({"0", "to", "24", "by", "0"}), eckit::BadValue);
+    EXPECT_THROWS_AS(language.type("levelist")->range({"1", "to", "abc"}), eckit::UserError);
+
+    // the values of a type restricting them are checked one by one, day being in [1, 31]
+    const Type* day = MarsLanguage::instance("disseminate").type("day");
+    EXPECT(!day->range({"1", "to", "31"}));
+    std::vector<std::string> days{"1", "to", "31", "by", "2"};
+    day->expand(days);
+    EXPECT_EQUAL(days.size(), 16);
+    for (const auto& values : std::vector<std::vector<std::string>>{
+             {"1", "to", "40"}, {"0", "to", "31"}, {"30", "to", "32"}}) {
+        std::vector<std::string> expanded = values;
+        EXPECT_THROWS_AS(day->expand(expanded), eckit::UserError);
+    }
+
+    MarsRequest r = MarsRequest::parse("ret,date=19790101/to/20251231,step=0/to/240/by/1,param=2t,levtype=sfc");
+    auto date     = std::find_if(r.parameters().begin(), r.parameters().end(),
+                                 [](const Parameter& p) { return p.name() == "date"; });
+    EXPECT(date != r.parameters().end());
+    EXPECT(date->range());
+    EXPECT_EQUAL(r.countValues("date"), 17167);
+    EXPECT_EQUAL(r.countValues("step"), 241);
+    EXPECT_EQUAL(r.count(), 17167 * 241);
+    EXPECT(date->range());  // still unexpanded
+
+    EXPECT_EQUAL(r.values("date").front(), "19790101");
+    EXPECT_EQUAL(r.values("date").back(), "20251231");
+
+    // modifying the values materialises the range
+    r.values("date", std::vector<std::string>{"20250101"});
+    EXPECT_EQUAL(r.countValues("date"), 1);
+}
+
+CASE("test_metkit_compact_range") {
+    const MarsLanguage& language = MarsLanguage::instance("retrieve");
+
+    for (const auto& [key, values, compacted] :
+         std::vector<std::tuple<std::string, std::vector<std::string>, std::vector<std::string>>>{
+             {"date", {"20250101", "to", "20250331"}, {"20250101", "to", "20250331"}},
+             {"date", {"20250101", "to", "20250331", "by", "7"}, {"20250101", "to", "20250326", "by", "7"}},
+             {"step", {"0", "to", "240", "by", "6"}, {"0", "to", "240", "by", "6"}},
+             {"step", {"0", "to", "24", "by", "3", "36", "48"}, {"0", "to", "24", "by", "3", "36", "48"}},
+             {"levelist", {"1", "to", "137"}, {"1", "to", "137"}},
+             {"levelist", {"1000", "850", "700", "500"}, {"1000", "850", "700", "500"}},
+             {"time", {"0000", "to", "1800", "by", "6h"}, {"0000", "to", "1800"}}}) {
+        const Type* t = language.type(key);
+
+        std::vector<std::string> expanded = values;
+        t->expand(expanded);
+
+        std::vector<std::string> c = expanded;
+        t->compact(c);
+        EXPECT_EQUAL(c, compacted);
+
+        // compacting is the inverse of expanding
+        t->expand(c);
+        EXPECT_EQUAL(c, expanded);
+    }
+
+    MarsRequest r = MarsRequest::parse(
+        "ret,date=20250101/20250102/20250103/20250104,step=0/6/12/18/24/30/36/42,param=2t/msl,levtype=sfc");
+    MarsRequest expanded = MarsExpansion(false).expand(r);
+    MarsRequest compact  = language.compact(expanded);
+
+    EXPECT_EQUAL(compact.values("date"), (std::vector<std::string>{"20250101", "to", "20250104"}));
+    EXPECT_EQUAL(compact.values("step"), (std::vector<std::string>{"0", "to", "42", "by", "6"}));
+    EXPECT_EQUAL(compact.values("param"), expanded.values("param"));
+
+    MarsRequest again = MarsExpansion(false).expand(compact);
+    EXPECT_EQUAL(again.count(), expanded.count());
+    EXPECT_EQUAL(again.values("date"), expanded.values("date"));
+    EXPECT_EQUAL(again.values("step"), expanded.values("step"));
+}
+
 CASE("test_metkit_files") {
 
     eckit::LocalPathName testFolder{"expand"};
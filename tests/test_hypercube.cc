@@ -13,10 +13,20 @@
 /// @author Florian Rathgeber
 
 #include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
 #include "eckit/testing/Test.h"
 
+#include "metkit/hypercube/ConcurrentHyperCube.h"
 #include "metkit/hypercube/HyperCube.h"
+#include "metkit/hypercube/HyperCubeFile.h"
+#include "metkit/hypercube/HyperCubePayloaded.h"
+#include "metkit/mars/MarsExpansion.h"
 #include "metkit/mars/MarsRequest.h"
 
 namespace metkit::mars::test {
@@ -176,6 +186,306 @@ CASE("test_metkit_hypercube_request METK-132") {
     }
 }
 
+CASE("test_metkit_hypercube_cover") {
+    std::vector<std::string> keys = {"levelist", "param", "step"};
+
+    MarsRequest r = MarsRequest::parse("retrieve,levelist=1/2/3/4/5,param=228038/235094/235077/235078,step=0/6/12");
+    metkit::hypercube::HyperCube cube{r};
+    EXPECT_EQUAL(cube.size(), 60);
+
+    std::vector<MarsRequest> fields = r.split(keys);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if ((i * 7) % 5 < 2 || i < 12) {
+            EXPECT(cube.clear(fields[i]));
+        }
+    }
+
+    // vacant requests cover exactly the fields still in the cube, the other requests the cleared ones
+    size_t vacant = 0;
+    for (const auto& req : cube.vacantRequests()) {
+        for (const auto& f : req.split(keys)) {
+            EXPECT(cube.contains(f));
+            vacant++;
+        }
+    }
+    EXPECT_EQUAL(vacant, cube.countVacant());
+
+    size_t cleared = 0;
+    for (const auto& req : cube.requests()) {
+        for (const auto& f : req.split(keys)) {
+            EXPECT(!cube.contains(f));
+            cleared++;
+        }
+    }
+    EXPECT_EQUAL(cleared, cube.size() - cube.countVacant());
+
+    // a slab of complete levels is covered by a single request
+    metkit::hypercube::HyperCube slab{r};
+    for (const auto& f : fields) {
+        if (f.values("levelist")[0] != "5") {
+            slab.clear(f);
+        }
+    }
+    EXPECT_EQUAL(slab.vacantRequests().size(), 1);
+    EXPECT_EQUAL(slab.requests().size(), 1);
+    EXPECT_EQUAL(slab.vacantRequests()[0].count(), 12);
+}
+
+CASE("test_metkit_hypercube_ordinal") {
+    std::vector<std::string> keys = {"levelist", "param"};
+
+    MarsRequest r = MarsRequest::parse("retrieve,levelist=2/4/1/3/5,param=228038/235094/235077/235078");
+    metkit::hypercube::HyperCube cube{r};
+
+    std::vector<MarsRequest> fields = r.split(keys);
+    for (size_t i = 0; i < fields.size(); i += 3) {
+        cube.clear(fields[i]);
+    }
+
+    // the vacant fields, in the order of the cube
+    std::vector<size_t> vacant;
+    for (const auto& f : fields) {
+        if (cube.contains(f)) {
+            vacant.push_back(cube.fieldOrdinal(f, false));
+        }
+    }
+    std::sort(vacant.begin(), vacant.end());
+    EXPECT_EQUAL(vacant.size(), cube.countVacant());
+
+    for (size_t n = 0; n < vacant.size(); ++n) {
+        MarsRequest f = cube.vacantField(n);
+        EXPECT(cube.contains(f));
+        EXPECT_EQUAL(cube.fieldOrdinal(f, false), vacant[n]);
+        EXPECT_EQUAL(cube.fieldOrdinal(f), n);
+    }
+
+    EXPECT_THROWS_AS(cube.vacantField(vacant.size()), eckit::UserError);
+}
+
+CASE("test_metkit_hypercube_concurrent") {
+    std::vector<std::string> keys = {"levelist", "param", "step"};
+
+    MarsRequest r = MarsRequest::parse("retrieve,levelist=1/2/3/4/5,param=228038/235094/235077/235078,step=0/6/12");
+    metkit::hypercube::ConcurrentHyperCube cube{r};
+    EXPECT_EQUAL(cube.size(), 60);
+    EXPECT_EQUAL(cube.countVacant(), 60);
+
+    std::vector<MarsRequest> fields = r.split(keys);
+
+    // producers clear overlapping sets of fields, each field is cleared by exactly one of them
+    std::atomic<size_t> cleared{0};
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < 4; ++t) {
+        producers.emplace_back([&, t] {
+            for (size_t i = t; i < fields.size(); i += 2) {
+                if (i % 5 != 0 && cube.clear(fields[i])) {
+                    cleared++;
+                }
+            }
+        });
+    }
+
+    // while a monitor polls the vacant fields
+    size_t polls = 0;
+    while (cube.countVacant() > 12 && polls++ < 1000) {
+        for (const auto& req : cube.vacantRequests()) {
+            EXPECT(req.count() > 0);
+        }
+    }
+
+    for (auto& p : producers) {
+        p.join();
+    }
+
+    EXPECT_EQUAL(cleared, 48);
+    EXPECT_EQUAL(cube.countVacant(), 12);
+
+    size_t vacant = 0;
+    for (const auto& req : cube.vacantRequests()) {
+        for (const auto& f : req.split(keys)) {
+            EXPECT(cube.contains(f));
+            vacant++;
+        }
+    }
+    EXPECT_EQUAL(vacant, 12);
+
+    size_t done = 0;
+    for (const auto& req : cube.requests()) {
+        for (const auto& f : req.split(keys)) {
+            EXPECT(!cube.contains(f));
+            done++;
+        }
+    }
+    EXPECT_EQUAL(done, 48);
+
+    EXPECT(!cube.clear(fields[1]));
+    EXPECT(!cube.clear(MarsRequest::parse("retrieve,levelist=6,param=228038,step=0")));
+}
+
+CASE("test_metkit_hypercube_compact") {
+    MarsRequest r = MarsExpansion(false).expand(MarsRequest::parse(
+        "retrieve,class=od,type=fc,stream=oper,expver=0001,levtype=pl,date=20250101,time=0000,"
+        "levelist=1000/850/700/500,param=t,step=0/to/48/by/3"));
+    metkit::hypercube::HyperCube cube{r};
+    EXPECT_EQUAL(cube.size(), 4 * 17);
+
+    // the fields of the upper levels arrived
+    for (const auto& f : r.split(std::vector<std::string>{"levelist", "step"})) {
+        if (f.values("levelist")[0] == "500" || f.values("levelist")[0] == "700") {
+            cube.clear(f);
+        }
+    }
+
+    std::vector<MarsRequest> vacant = cube.vacantRequests(true);
+    EXPECT_EQUAL(vacant.size(), 1);
+    EXPECT_EQUAL(vacant[0].values("step"), (std::vector<std::string>{"0", "to", "48", "by", "3"}));
+    EXPECT_EQUAL(vacant[0].values("levelist"), (std::vector<std::string>{"1000", "850"}));
+
+    // the compact requests expand to the same fields
+    MarsRequest expanded = MarsExpansion(false).expand(vacant[0]);
+    EXPECT_EQUAL(expanded.count(), cube.countVacant());
+    EXPECT_EQUAL(expanded.values("step"), cube.vacantRequests()[0].values("step"));
+}
+
+// saved byte for byte, so without padding
+struct Location {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(Location) == 16);
+
+struct LastLocation : public metkit::hypercube::Deduplicator<Location> {
+    bool toReplace(const Location&, const Location&) const override { return true; }
+};
+
+CASE("test_metkit_hypercube_file") {
+    using metkit::hypercube::HyperCubeFile;
+
+    std::vector<std::string> keys = {"levelist", "param", "step"};
+
+    MarsRequest r = MarsRequest::parse("retrieve,levelist=1/2/3/4/5,param=228038/235094/235077/235078,step=0/6/12");
+    std::vector<MarsRequest> fields = r.split(keys);
+
+    eckit::PathName path("test_metkit_hypercube_file.cube");
+
+    metkit::hypercube::HyperCube cube{r};
+    for (size_t i = 0; i < fields.size(); i += 3) {
+        cube.clear(fields[i]);
+    }
+    cube.save(path);
+
+    {
+        HyperCubeFile file(path);
+        EXPECT_EQUAL(file.size(), cube.size());
+        EXPECT_EQUAL(file.countVacant(), cube.countVacant());
+        EXPECT(file.layout() == HyperCubeFile::Layout::None);
+        for (const auto& f : fields) {
+            EXPECT_EQUAL(file.contains(f), cube.contains(f));
+        }
+        EXPECT_EQUAL(file.vacantRequests().size(), cube.vacantRequests().size());
+        EXPECT_THROWS_AS(file.payload<Location>(fields[0]), eckit::BadValue);
+
+        // carry on clearing fields in the reopened cube
+        metkit::hypercube::HyperCube reopened(file);
+        EXPECT_EQUAL(reopened.countVacant(), cube.countVacant());
+        EXPECT(!reopened.clear(fields[0]));
+        EXPECT(reopened.clear(fields[1]));
+        EXPECT_EQUAL(reopened.countVacant(), cube.countVacant() - 1);
+    }
+
+    LastLocation dedup;
+    for (auto layout : {HyperCubeFile::Layout::Dense, HyperCubeFile::Layout::Sparse}) {
+        metkit::hypercube::HyperCubePayloaded<Location> payloaded(r, dedup);
+        for (size_t i = 0; i < fields.size(); i += 7) {
+            payloaded.add(fields[i], Location{i * 1000, uint32_t(i)});
+        }
+        payloaded.save(path, layout);
+
+        HyperCubeFile file(path);
+        EXPECT(file.layout() == layout);
+        EXPECT_EQUAL(file.payloadSize(), sizeof(Location));
+        EXPECT_EQUAL(file.countPayloads(), 9);
+        EXPECT_EQUAL(file.countVacant(), payloaded.countVacant());
+
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const Location* l = file.payload<Location>(fields[i]);
+            EXPECT_EQUAL(l != nullptr, i % 7 == 0);
+            if (l) {
+                EXPECT_EQUAL(l->offset, i * 1000);
+                EXPECT_EQUAL(l->length, i);
+            }
+        }
+
+        metkit::hypercube::HyperCubePayloaded<Location> reopened(file, dedup);
+        EXPECT_EQUAL(reopened.countVacant(), payloaded.countVacant());
+        for (size_t i = 0; i < fields.size(); ++i) {
+            Location l;
+            int idx = payloaded.fieldOrdinal(fields[i], false);
+            EXPECT_EQUAL(reopened.find(idx, l), i % 7 == 0);
+        }
+    }
+
+    path.unlink();
+}
+
+CASE("test_metkit_hypercube_file_sparse") {
+    using metkit::hypercube::HyperCubeFile;
+
+    // 1200 cells, so that payloads are found through the ranks of several blocks of 512 cells
+    std::ostringstream levels;
+    for (size_t l = 1; l <= 100; ++l) {
+        levels << (l > 1 ? "/" : "") << l;
+    }
+    MarsRequest r = MarsRequest::parse("retrieve,levelist=" + levels.str() +
+                                       ",param=228038/235094/235077/235078,step=0/6/12");
+    std::vector<MarsRequest> fields = r.split(std::vector<std::string>{"levelist", "param", "step"});
+    EXPECT_EQUAL(fields.size(), 1200);
+
+    eckit::PathName path("test_metkit_hypercube_file_sparse.cube");
+
+    // some cells of every block, and runs of cells on either side of the block boundaries
+    auto holds = [](size_t i) { return i % 13 == 0 || (i + 40) % 512 < 80; };
+
+    LastLocation dedup;
+    metkit::hypercube::HyperCubePayloaded<Location> payloaded(r, dedup);
+    size_t count = 0;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (holds(i)) {
+            payloaded.add(fields[i], Location{i * 1000, uint32_t(i)});
+            ++count;
+        }
+    }
+    payloaded.save(path, HyperCubeFile::Layout::Sparse);
+
+    {
+        HyperCubeFile file(path);
+        EXPECT(file.layout() == HyperCubeFile::Layout::Sparse);
+        EXPECT_EQUAL(file.countPayloads(), count);
+
+        for (size_t i = 0; i < fields.size(); ++i) {
+            const Location* l = file.payload<Location>(fields[i]);
+            EXPECT_EQUAL(l != nullptr, holds(i));
+            if (l) {
+                EXPECT_EQUAL(l->offset, i * 1000);
+                EXPECT_EQUAL(l->length, i);
+            }
+        }
+    }
+
+    // a file with a layout this version does not know is rejected
+    {
+        std::fstream out(path.asString(), std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t layout = 3;
+        out.seekp(12);  // after the magic and the version
+        out.write(reinterpret_cast<const char*>(&layout), sizeof(layout));
+    }
+    EXPECT_THROWS_AS(HyperCubeFile{path}, eckit::BadValue);
+
+    path.unlink();
+}
+
 }  // namespace metkit::mars::test
 
 int main(int argc, char** argv) {
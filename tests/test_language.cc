@@ -20,6 +20,7 @@
 #include "eckit/types/Date.h"
 #include "eckit/value/Value.h"
 
+#include "metkit/mars/FlattenSpace.h"
 #include "metkit/mars/MarsExpansion.h"
 #include "metkit/mars/MarsLanguage.h"
 #include "metkit/mars/MarsRequest.h"
@@ -285,6 +286,57 @@ CASE("check method: flatten()") {
                  "167,expver=0001,domain=g\n");
 }
 
+CASE("check FlattenSpace") {
+
+    auto request = MarsRequest::parse(
+        "retrieve,class=od,type=an,stream=oper,levtype=pl,time=0000/1200,param=2t/2d,step=10/to/14/by/2,levelist=300/"
+        "400/500,date=20250717",
+        true);
+
+    struct Output : public FlattenCallback {
+        std::vector<std::string> fields;
+        void operator()(const MarsRequest& request) override { fields.push_back(request.asString()); }
+    };
+
+    Output output;
+    MarsLanguage("retrieve").flatten(request, output);
+
+    FlattenSpace space(request);
+    EXPECT_EQUAL(space.size(), 2 * 2 * 3 * 3);
+    EXPECT_EQUAL(space.size(), output.fields.size());
+
+    // the last keyword varies fastest
+    std::vector<std::string> fields;
+    for (const MarsRequest& field : space) {
+        EXPECT_EQUAL(field.countValues("levelist"), 1);
+        fields.push_back(field.asString());
+    }
+    EXPECT_EQUAL(fields, output.fields);
+    EXPECT_EQUAL(space[1].values("param"), std::vector<std::string>{"168"});
+    EXPECT_EQUAL(space[2].values("step"), std::vector<std::string>{"10"});
+    EXPECT_EQUAL(space[2].values("levelist"), std::vector<std::string>{"400"});
+
+    // random access
+    for (size_t i = 0; i < space.size(); ++i) {
+        EXPECT_EQUAL(space[i].asString(), fields[i]);
+        EXPECT_EQUAL(space.at(i).ordinal(), i);
+    }
+    EXPECT(space.at(space.size()) == space.end());
+
+    // partitions are contiguous and cover the space
+    for (size_t n : {1, 2, 5, 36, 50}) {
+        std::vector<std::string> joined;
+        for (size_t i = 0; i < n; ++i) {
+            auto [first, last] = space.partition(i, n);
+            EXPECT(last.ordinal() - first.ordinal() <= (space.size() + n - 1) / n);
+            for (auto j = first; j != last; ++j) {
+                joined.push_back(j->asString());
+            }
+        }
+        EXPECT_EQUAL(joined, fields);
+    }
+}
+
 CASE("check some types") {
 
     {
@@ -11,6 +11,7 @@
 #include "eckit/testing/Test.h"
 #include "metkit/mars/MarsRequest.h"
 #include "metkit/mars/Matcher.h"
+#include "metkit/mars/MatcherSet.h"
 
 #include <sstream>
 
@@ -162,6 +163,65 @@ CASE("streaming matcher is deterministic") {
     EXPECT_EQUAL(oss.str(), "{expver=(x[0-9a-z]{3}),number=(1|2),stream=^enfo$}");
 }
 
+CASE("matcher set") {
+    std::vector<std::string> exprs = {
+        "expver=(x[0-9a-z]{3}),number=(1|2),stream=^enfo$",
+        "class=^(od|rd)$,stream=^enfo$",
+        "class=od",
+        "expver=^0001,stream=enfo|oper",
+        "number=^[0-9]+$",
+        "expver=(x[0-9a-z]{3}),class=^rd$",
+    };
+
+    std::vector<Matcher> rules;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+        rules.emplace_back(exprs[i], i % 2 ? Matcher::Policy::Any : Matcher::Policy::All);
+    }
+    MatcherSet set(rules);
+    EXPECT_EQUAL(set.size(), rules.size());
+
+    std::vector<MarsRequest> requests;
+    {
+        MarsRequest req("retrieve");
+        req.setValue("class", "od");
+        req.setValue("expver", "xxxx");
+        req.values("number", {"1", "2", "3"});
+        req.setValue("stream", "enfo");
+        requests.push_back(req);
+    }
+    {
+        MarsRequest req("retrieve");
+        req.setValue("class", "prod");
+        req.setValue("expver", "00012");
+        req.setValue("stream", "oper");
+        requests.push_back(req);
+    }
+    {
+        MarsRequest req("retrieve");
+        req.setValue("class", "rd");
+        req.values("number", {"10", "11"});
+        requests.push_back(req);
+    }
+    requests.emplace_back("retrieve");
+
+    for (const auto& req : requests) {
+        for (auto policy : {Matcher::MatchOnMissing, Matcher::DontMatchOnMissing}) {
+            MatcherSet::Result result = set.match(req, policy);
+            EXPECT_EQUAL(result.size(), rules.size());
+
+            size_t count = 0;
+            for (size_t i = 0; i < rules.size(); ++i) {
+                EXPECT_EQUAL(result.test(i), rules[i].match(req, policy));
+                count += rules[i].match(req, policy) ? 1 : 0;
+            }
+            EXPECT_EQUAL(result.count(), count);
+        }
+    }
+
+    MatcherSet::Result result = set.match(requests[0], Matcher::DontMatchOnMissing);
+    EXPECT(result.indices() == (std::vector<size_t>{1, 2, 4}));
+}
+
 // ----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace metkit::test
@@ -57,6 +57,8 @@ static void test_param_axis(const std::vector<std::string>& user, const std::vec
     std::cout << "User:" << params << std::endl;
     std::cout << "NormalisationMode:" << static_cast<int>(mode) << std::endl;
 
+    std::vector<Param> indexed(params);
+
     ParamID::normalise(ignore, params, index, windRequested, mode);
 
     std::cout << "Params expected: " << expected << std::endl;
@@ -66,6 +68,12 @@ static void test_param_axis(const std::vector<std::string>& user, const std::vec
 
     EXPECT_EQUAL(params, expected);
     EXPECT_EQUAL(expectWind, windRequested);
+
+    // same result with a prebuilt axis index
+    bool indexedWind = false;
+    ParamID::normalise(ignore, indexed, ParamID::AxisIndex(index), indexedWind, mode);
+    EXPECT_EQUAL(indexed, expected);
+    EXPECT_EQUAL(expectWind, indexedWind);
 }
 
 void assertTypeExpansion(const std::string& name, std::vector<std::string> values,
@@ -0,0 +1,71 @@
+/*
+ * (C) Copyright 2026- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @file   test_prefix_matcher.cc
+/// @date   Oct 2026
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "metkit/mars/PrefixMatcher.h"
+
+namespace metkit::mars::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("exact matches ignore case and resolve aliases") {
+    PrefixMatcher m({"class", "stream", "levelist", "levels", "levtype"}, {{"levels", "levelist"}});
+
+    EXPECT_EQUAL(m.match("class", true, true, true), "class");
+    EXPECT_EQUAL(m.match("CLASS", true, true, true), "class");
+    EXPECT_EQUAL(m.match("levels", true, true, true), "levelist");
+
+    EXPECT(m.exact("Stream") != nullptr);
+    EXPECT_EQUAL(*m.exact("Stream"), "stream");
+    EXPECT(m.exact("strea") == nullptr);
+}
+
+CASE("the first of equal values wins") {
+    PrefixMatcher m({"T", "t"}, {{"T", "130"}});
+    EXPECT_EQUAL(m.match("t", true, true, false), "130");
+}
+
+CASE("missing and ambiguous values") {
+    PrefixMatcher m({"levelist", "levtype", "class"});
+
+    EXPECT_EQUAL(m.match("date", false, true, false), "");
+    EXPECT_THROWS_AS(m.match("date", true, true, false), eckit::UserError);
+
+    // 'lev' could be both levelist and levtype
+    EXPECT_EQUAL(m.match("lev", false, true, true), "");
+    EXPECT_THROWS_AS(m.match("lev", true, true, true), eckit::UserError);
+
+    // ... unless they are aliases of the same value
+    PrefixMatcher a({"levelist", "levels"}, {{"levels", "levelist"}});
+    EXPECT_EQUAL(a.match("leve", true, true, true), "levelist");
+}
+
+CASE("empty matcher") {
+    PrefixMatcher m;
+    EXPECT(m.empty());
+    EXPECT(m.exact("anything") == nullptr);
+    EXPECT_EQUAL(m.match("anything", false, true, true), "");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace metkit::mars::test
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -12,9 +12,12 @@
 /// @date   Jul 2024
 /// @author Emanuele Danovaro
 
+#include <sstream>
+
 #include "eckit/log/JSON.h"
 #include "eckit/types/Date.h"
 
+#include "metkit/mars/MarsBufferParser.h"
 #include "metkit/mars/MarsExpansion.h"
 #include "metkit/mars/MarsLanguage.h"
 #include "metkit/mars/MarsParser.h"
@@ -204,6 +207,177 @@ CASE("test_request_count_single_level_params") {
     }
 }
 
+CASE("test_request_storage") {
+    MarsRequest r("retrieve");
+    r.setValue("class", "od");
+    r.setValue("stream", "oper");
+    r.values("step", std::vector<std::string>{"0", "6", "12"});
+
+    EXPECT(r.has("class"));
+    EXPECT(!r.has("an-unknown-keyword"));
+    EXPECT_EQUAL(r.countValues("step"), 3);
+    EXPECT_EQUAL(r.params(), std::vector<std::string>({"class", "stream", "step"}));
+
+    // copies do not share modifications
+    MarsRequest copy(r);
+    copy.setValue("class", "rd");
+    copy.values("step", std::vector<std::string>{"24"});
+    EXPECT_EQUAL(r["class"], "od");
+    EXPECT_EQUAL(r.countValues("step"), 3);
+    EXPECT_EQUAL(copy["class"], "rd");
+    EXPECT_EQUAL(copy.countValues("step"), 1);
+
+    MarsRequest other(r);
+    other.merge(copy);
+    EXPECT_EQUAL(other.values("step"), std::vector<std::string>({"0", "6", "12", "24"}));
+    EXPECT_EQUAL(r.values("step"), std::vector<std::string>({"0", "6", "12"}));
+
+    // order is preserved when parameters are removed
+    r.unsetValues("class");
+    EXPECT_EQUAL(r.params(), std::vector<std::string>({"stream", "step"}));
+    r.setValue("class", "od");
+    EXPECT_EQUAL(r.params(), std::vector<std::string>({"stream", "step", "class"}));
+}
+
+CASE("test_request_merge") {
+    std::vector<MarsRequest> requests;
+    for (size_t i = 0; i < 100; ++i) {
+        MarsRequest r("retrieve");
+        r.setValue("class", "od");
+        r.setValue("step", std::to_string(i % 10));
+        r.setValue("param", std::to_string(100 - i % 7));
+        if (i == 50) {
+            r.setValue("levelist", "500");  // only present in one request, ignored
+        }
+        requests.push_back(r);
+    }
+
+    MarsRequest folded(requests.front());
+    for (size_t i = 1; i < requests.size(); ++i) {
+        folded.merge(requests[i]);
+    }
+
+    MarsRequest merged = MarsRequest::merge(requests.begin(), requests.end());
+    EXPECT_EQUAL(merged.asString(), folded.asString());
+
+    EXPECT_EQUAL(merged.values("class"), std::vector<std::string>({"od"}));
+    EXPECT_EQUAL(merged.countValues("step"), 10);
+    EXPECT_EQUAL(merged.values("param"), std::vector<std::string>({"100", "99", "98", "97", "96", "95", "94"}));
+    EXPECT(!merged.has("levelist"));
+
+    // the merged requests are not modified
+    EXPECT_EQUAL(requests.front().countValues("step"), 1);
+}
+
+CASE("test_request_typed") {
+    const MarsLanguage& language = MarsLanguage::instance("retrieve");
+
+    for (const auto& [key, values] : std::vector<std::pair<std::string, std::vector<std::string>>>{
+             {"date", {"20250101", "19000301", "20240229"}},
+             {"time", {"0000", "1230", "2300"}},
+             {"step", {"0", "6", "0-24", "30m", "1h30m"}},
+             {"levelist", {"1", "850", "1000"}},
+             {"number", {"0", "-1", "50"}}}) {
+        const Type* t = language.type(key);
+        for (const auto& v : values) {
+            TypedValue typed = t->encode(v);
+            EXPECT(typed);
+            EXPECT_EQUAL(t->decode(typed), v);
+        }
+    }
+
+    // only canonical values have a binary form
+    EXPECT(!language.type("date")->encode("20250230"));
+    EXPECT(!language.type("date")->encode("jan-1"));
+    EXPECT(!language.type("time")->encode("12"));
+    EXPECT(!language.type("levelist")->encode("0850"));
+    EXPECT(!language.type("number")->encode("-0"));
+    EXPECT(!language.type("class")->encode("od"));
+
+    EXPECT(language.type("date")->encode("20250101") < language.type("date")->encode("20250102"));
+    EXPECT(language.type("step")->encode("6") < language.type("step")->encode("12"));
+
+    MarsRequest r = MarsRequest::parse("ret,date=20250101/to/20250110,time=0/12,step=0/to/24/by/6,param=t,levelist=850");
+    const Parameter& date = *std::find_if(r.parameters().begin(), r.parameters().end(),
+                                          [](const Parameter& p) { return p.name() == "date"; });
+    EXPECT(date.typed());
+    EXPECT_EQUAL(date.typed()->size(), 10);
+
+    // matching and filtering on requests of the same language compares the binary forms
+    MarsRequest match = MarsRequest::parse("ret,date=20250105/20250201,time=12,step=12,param=t,levelist=850");
+    EXPECT(r.matches(match));
+    match.setValue("levelist", "500");
+    EXPECT(!r.matches(match));
+
+    MarsRequest filter = MarsRequest::parse("ret,date=20250105/20250201,time=12,step=12/18,param=t,levelist=850");
+    EXPECT(r.filter(filter));
+    EXPECT_EQUAL(r.values("date"), std::vector<std::string>{"20250105"});
+    EXPECT_EQUAL(r.values("step"), std::vector<std::string>({"12", "18"}));
+    const Parameter& step = *std::find_if(r.parameters().begin(), r.parameters().end(),
+                                          [](const Parameter& p) { return p.name() == "step"; });
+    EXPECT(step.typed());
+    EXPECT_EQUAL(step.typed()->size(), 2);
+}
+
+CASE("test_request_buffer_parser") {
+    const char* texts[] = {
+        "retrieve,class=od,date=20240729,time=00/12,param=2t/msl",
+        "retrieve , class = od ,\n  date = -1 / to / -3 .\nlist,class=rd",
+        "# leading comment\nretrieve,expver=0001, # trailing comment\n target = \"out put.grib\" # done\n",
+        "archive,source='a/b.grib',database=\"marser\",param=\"a\\\"b\\\\c\\/d\\n\"",
+        "retrieve,grid=0.25/0.25,area=90/-180/-90/180,obstype=my obs  type/other,step=0-24",
+        "_verb,key with spaces=value with   spaces.\n\nread,source=x.\nwrite,target=y",
+        "",
+        "   # only a comment",
+    };
+
+    for (const char* text : texts) {
+        std::istringstream in(text);
+        MarsParser streamParser(in);
+        std::vector<MarsParsedRequest> expected = streamParser.parse();
+
+        MarsBufferParser bufferParser(text);
+        std::vector<MarsParsedRequest> parsed = bufferParser.parse();
+
+        EXPECT_EQUAL(parsed.size(), expected.size());
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            EXPECT_EQUAL(parsed[i].verb(), expected[i].verb());
+            EXPECT(parsed[i].params() == expected[i].params());
+            for (const auto& p : parsed[i].params()) {
+                EXPECT(parsed[i].values(p) == expected[i].values(p));
+            }
+        }
+    }
+
+    {
+        MarsBufferParser parser("retrieve,param=2t,\n\n  # comment\n date=1 .\n\nlist,class=od");
+        std::vector<MarsParsedRequest> v = parser.parse();
+        EXPECT_EQUAL(v.size(), 2);
+        EXPECT(v[0].values("date") == std::vector<std::string>{"1"});
+        EXPECT_EQUAL(v[1].verb(), "list");
+    }
+
+    for (const char* text : {"retrieve,param", "retrieve,target=\"abc", "1retrieve", "retrieve,target=\"\\x\""}) {
+        MarsBufferParser parser(text);
+        EXPECT_THROWS_AS(parser.parse(), eckit::StreamParser::Error);
+    }
+}
+
+CASE("test_request_parameter_moved_from") {
+    MarsRequest r = MarsRequest::parse("retrieve,param=2t,date=20250101,step=0/6/12");
+    MarsRequest::Parameters& params = r.parameters();
+
+    Parameter p = params.front();
+    Parameter moved(std::move(p));
+    EXPECT_EQUAL(moved.name(), params.front().name());
+
+    // a moved-from parameter is left as a default constructed one
+    Parameter empty;
+    EXPECT_EQUAL(p.name(), empty.name());
+    EXPECT_EQUAL(p.count(), empty.count());
+    EXPECT(p.values().empty());
+}
+
 //-----------------------------------------------------------------------------
 
 }  // namespace test
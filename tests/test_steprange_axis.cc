@@ -105,11 +105,21 @@ static void test_steprange_axis(const std::vector<std::string>& user, const std:
     std::cout << "User:" << values << std::endl;
     std::cout << "Axis:" << index << std::endl;
 
+    std::vector<StepRange> indexed(values);
+
     StepRangeNormalise::normalise(values, index);
 
     std::cout << "Result:" << values << std::endl;
 
     EXPECT(values == result);
+
+    // same result with a prebuilt axis index, which can be used more than once
+    StepRangeNormalise::AxisIndex axisIndex(index);
+    std::vector<StepRange> again(indexed);
+    StepRangeNormalise::normalise(indexed, axisIndex);
+    StepRangeNormalise::normalise(again, axisIndex);
+    EXPECT(indexed == result);
+    EXPECT(again == result);
 }
 
 